@@ -0,0 +1,215 @@
+/***********************************
+ * aggregate.c
+ *
+ * CGPA Calculator - structure-of-arrays transcript view and totals kernel
+ *
+ * Handles:
+ * - flattening the course list into contiguous arrays
+ * - SIMD (AVX2/SSE2) and scalar reduction of weights and credits
+ *
+ * Author: Arul Rao (Vidonicle)
+ * License: MIT
+ ***********************************/
+
+#include "aggregate.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#include "cgpa.h"
+#include "courselist.h"
+#include "scale.h"
+
+#define AGGREGATE_BATCH_LEN 256  // Rows per kernel call in courses_totals
+
+#if !defined(CGPA_NO_SIMD) && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CGPA_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+// Flatten list into SoA arrays
+bool soa_build(transcript_soa_t *soa, const courselist_t *courses) {
+    soa->count = 0;
+    soa->weight = malloc((courses->count ? courses->count : 1) * sizeof(float));
+    soa->grade_points = malloc((courses->count ? courses->count : 1) * sizeof(float));
+
+    if (!soa->weight || !soa->grade_points) {
+        soa_free(soa);
+        return false;
+    }
+
+    const float *points = scale_points(courses->scale);
+
+    for (const coursenode_t *curr = courses->head; curr; curr = curr->next) {
+        soa->weight[soa->count] = curr->course_weight;
+        soa->grade_points[soa->count] = points[curr->grade];
+        soa->count++;
+    }
+
+    return true;
+}
+
+void soa_free(transcript_soa_t *soa) {
+    free(soa->weight);
+    free(soa->grade_points);
+    soa->weight = NULL;
+    soa->grade_points = NULL;
+    soa->count = 0;
+}
+
+// Totals for a whole SoA view
+void soa_totals(const transcript_soa_t *soa, cgpa_totals_t *totals) {
+    totals->credits_earned = 0.0;
+    totals->credits_completed = 0.0;
+
+    cgpa_accumulate(totals, soa->weight, soa->grade_points, soa->count);
+    cgpa_finalize(totals);
+}
+
+static void accumulate_scalar(const float *weight, const float *grade_points, size_t count,
+                              double *sum_weight, double *sum_credits) {
+    double w_acc = 0.0;
+    double c_acc = 0.0;
+
+    for (size_t i = 0; i < count; i++) {
+        w_acc += weight[i];
+        c_acc += (double)weight[i] * grade_points[i];
+    }
+
+    *sum_weight += w_acc;
+    *sum_credits += c_acc;
+}
+
+#ifdef CGPA_X86_SIMD
+/*
+ * 8 rows per step, widened to double so long transcripts do not drift.
+ * Multiply then add (no FMA), with the same lane layout as the SSE2
+ * kernel, so totals do not depend on the CPU.
+ */
+__attribute__((target("avx2"))) static void accumulate_avx2(const float *weight,
+                                                            const float *grade_points,
+                                                            size_t count, double *sum_weight,
+                                                            double *sum_credits) {
+    __m256d w_lo_acc = _mm256_setzero_pd();
+    __m256d w_hi_acc = _mm256_setzero_pd();
+    __m256d c_lo_acc = _mm256_setzero_pd();
+    __m256d c_hi_acc = _mm256_setzero_pd();
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+        __m256 w = _mm256_loadu_ps(weight + i);
+        __m256 p = _mm256_loadu_ps(grade_points + i);
+
+        __m256d w_lo = _mm256_cvtps_pd(_mm256_castps256_ps128(w));
+        __m256d w_hi = _mm256_cvtps_pd(_mm256_extractf128_ps(w, 1));
+        __m256d p_lo = _mm256_cvtps_pd(_mm256_castps256_ps128(p));
+        __m256d p_hi = _mm256_cvtps_pd(_mm256_extractf128_ps(p, 1));
+
+        w_lo_acc = _mm256_add_pd(w_lo_acc, w_lo);
+        w_hi_acc = _mm256_add_pd(w_hi_acc, w_hi);
+        c_lo_acc = _mm256_add_pd(c_lo_acc, _mm256_mul_pd(w_lo, p_lo));
+        c_hi_acc = _mm256_add_pd(c_hi_acc, _mm256_mul_pd(w_hi, p_hi));
+    }
+
+    double lanes[4];
+
+    _mm256_storeu_pd(lanes, _mm256_add_pd(w_lo_acc, w_hi_acc));
+    *sum_weight += (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    _mm256_storeu_pd(lanes, _mm256_add_pd(c_lo_acc, c_hi_acc));
+    *sum_credits += (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+
+    accumulate_scalar(weight + i, grade_points + i, count - i, sum_weight, sum_credits);
+}
+
+#ifdef __SSE2__
+/*
+ * 8 rows per step using baseline x86-64 instructions. Row j of a step
+ * goes to the same double lane as in accumulate_avx2, and lanes are
+ * combined in the same order, so both kernels round identically.
+ */
+static void accumulate_sse2(const float *weight, const float *grade_points, size_t count,
+                            double *sum_weight, double *sum_credits) {
+    __m128d w_acc[4] = {_mm_setzero_pd(), _mm_setzero_pd(), _mm_setzero_pd(), _mm_setzero_pd()};
+    __m128d c_acc[4] = {_mm_setzero_pd(), _mm_setzero_pd(), _mm_setzero_pd(), _mm_setzero_pd()};
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+        for (size_t half = 0; half < 2; half++) {
+            __m128 w = _mm_loadu_ps(weight + i + 4 * half);
+            __m128 p = _mm_loadu_ps(grade_points + i + 4 * half);
+
+            __m128d w_lo = _mm_cvtps_pd(w);
+            __m128d w_hi = _mm_cvtps_pd(_mm_movehl_ps(w, w));
+            __m128d p_lo = _mm_cvtps_pd(p);
+            __m128d p_hi = _mm_cvtps_pd(_mm_movehl_ps(p, p));
+
+            w_acc[2 * half] = _mm_add_pd(w_acc[2 * half], w_lo);
+            w_acc[2 * half + 1] = _mm_add_pd(w_acc[2 * half + 1], w_hi);
+            c_acc[2 * half] = _mm_add_pd(c_acc[2 * half], _mm_mul_pd(w_lo, p_lo));
+            c_acc[2 * half + 1] = _mm_add_pd(c_acc[2 * half + 1], _mm_mul_pd(w_hi, p_hi));
+        }
+    }
+
+    double lanes[4];
+
+    // Rows 0-3 plus rows 4-7, lane by lane, as accumulate_avx2 does
+    _mm_storeu_pd(lanes, _mm_add_pd(w_acc[0], w_acc[2]));
+    _mm_storeu_pd(lanes + 2, _mm_add_pd(w_acc[1], w_acc[3]));
+    *sum_weight += (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    _mm_storeu_pd(lanes, _mm_add_pd(c_acc[0], c_acc[2]));
+    _mm_storeu_pd(lanes + 2, _mm_add_pd(c_acc[1], c_acc[3]));
+    *sum_credits += (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+
+    accumulate_scalar(weight + i, grade_points + i, count - i, sum_weight, sum_credits);
+}
+#endif /* __SSE2__ */
+#endif /* CGPA_X86_SIMD */
+
+void cgpa_accumulate(cgpa_totals_t *totals, const float *weight, const float *grade_points,
+                     size_t count) {
+#ifdef CGPA_X86_SIMD
+    if (__builtin_cpu_supports("avx2")) {
+        accumulate_avx2(weight, grade_points, count, &totals->credits_completed,
+                        &totals->credits_earned);
+        return;
+    }
+#ifdef __SSE2__
+    accumulate_sse2(weight, grade_points, count, &totals->credits_completed,
+                    &totals->credits_earned);
+    return;
+#endif
+#endif
+    accumulate_scalar(weight, grade_points, count, &totals->credits_completed,
+                      &totals->credits_earned);
+}
+
+void cgpa_finalize(cgpa_totals_t *totals) {
+    totals->cgpa = totals->credits_completed > 0.0
+                       ? totals->credits_earned / totals->credits_completed
+                       : 0.0;
+}
+
+// Totals for a course list, reduced in stack batches (no allocation)
+void courses_totals(const courselist_t *courses, cgpa_totals_t *totals) {
+    float weight[AGGREGATE_BATCH_LEN];
+    float points[AGGREGATE_BATCH_LEN];
+    const float *scale = scale_points(courses->scale);
+    size_t batched = 0;
+
+    totals->credits_earned = 0.0;
+    totals->credits_completed = 0.0;
+
+    for (const coursenode_t *curr = courses->head; curr; curr = curr->next) {
+        weight[batched] = curr->course_weight;
+        points[batched] = scale[curr->grade];
+
+        if (++batched == AGGREGATE_BATCH_LEN) {
+            cgpa_accumulate(totals, weight, points, batched);
+            batched = 0;
+        }
+    }
+
+    cgpa_accumulate(totals, weight, points, batched);
+    cgpa_finalize(totals);
+}
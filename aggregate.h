@@ -0,0 +1,48 @@
+/***********************************
+ * aggregate.h
+ *
+ * CGPA Calculator - structure-of-arrays transcript view and totals kernel
+ *
+ * Defines:
+ * - contiguous weight / grade point arrays built from a course list
+ * - vectorized reduction of those arrays into CGPA totals
+ *
+ * Author: Arul Rao (Vidonicle)
+ * License: MIT
+ ***********************************/
+
+#ifndef AGGREGATE_H
+#define AGGREGATE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "courselist.h"
+
+typedef struct {
+    float *weight;        // Course weights
+    float *grade_points;  // Grade points per unit of weight
+    size_t count;
+} transcript_soa_t;
+
+bool soa_build(transcript_soa_t *soa, const courselist_t *courses);
+
+void soa_free(transcript_soa_t *soa);
+
+void soa_totals(const transcript_soa_t *soa, cgpa_totals_t *totals);
+
+/*
+ * Add count rows to running totals.
+ * Uses AVX2 or SSE2 when available, scalar code otherwise.
+ * Build with -DCGPA_NO_SIMD to force the scalar path.
+ */
+void cgpa_accumulate(cgpa_totals_t *totals, const float *weight, const float *grade_points,
+                     size_t count);
+
+// Compute CGPA from accumulated totals
+void cgpa_finalize(cgpa_totals_t *totals);
+
+// Totals for a course list, reduced in stack batches (no allocation)
+void courses_totals(const courselist_t *courses, cgpa_totals_t *totals);
+
+#endif /* AGGREGATE_H */
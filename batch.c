@@ -0,0 +1,334 @@
+/***********************************
+ * batch.c
+ *
+ * CGPA Calculator - cohort (multi-student) batch processing
+ *
+ * Handles:
+ * - grouping course records by student ID in a hash table
+ * - per-student CGPA and credit totals
+ *
+ * Author: Arul Rao (Vidonicle)
+ * License: MIT
+ ***********************************/
+#define _POSIX_C_SOURCE 200809L
+
+#include "batch.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cgpa.h"
+#include "courselist.h"
+#include "instrument.h"
+#include "loader.h"
+#include "scale.h"
+
+#define COHORT_MIN_CAPACITY 1024  // Initial table size, for students and for courses
+#define ID_BLOCK_LEN 65536        // Bytes per student ID block
+
+static bool is_blank(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+// FNV-1a over the ID bytes
+static uint64_t id_hash(const char *id, size_t len) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+
+    for (size_t i = 0; i < len; i++) {
+        hash ^= (unsigned char)id[i];
+        hash *= 0x100000001b3ULL;
+    }
+
+    return hash;
+}
+
+// Copy an ID into block storage
+static const char *id_store(cohort_t *cohort, const char *id, size_t len) {
+    id_block_t *block = cohort->ids;
+
+    if (!block || block->used + len + 1 > ID_BLOCK_LEN) {
+        block = malloc(sizeof(id_block_t) + ID_BLOCK_LEN);
+        if (!block)
+            return NULL;
+
+        block->next = cohort->ids;
+        block->used = 0;
+        cohort->ids = block;
+    }
+
+    char *copy = block->data + block->used;
+    memcpy(copy, id, len);
+    copy[len] = '\0';
+    block->used += len + 1;
+
+    return copy;
+}
+
+// Double the table and reinsert every student
+static bool cohort_grow(cohort_t *cohort) {
+    size_t capacity = cohort->capacity ? cohort->capacity * 2 : COHORT_MIN_CAPACITY;
+    student_totals_t *slots = calloc(capacity, sizeof(student_totals_t));
+    if (!slots)
+        return false;
+
+    for (size_t i = 0; i < cohort->capacity; i++) {
+        const student_totals_t *old = &cohort->slots[i];
+        if (!old->student_id)
+            continue;
+
+        size_t pos = old->hash & (capacity - 1);
+        while (slots[pos].student_id)
+            pos = (pos + 1) & (capacity - 1);
+
+        slots[pos] = *old;
+    }
+
+    free(cohort->slots);
+    cohort->slots = slots;
+    cohort->capacity = capacity;
+
+    return true;
+}
+
+// Find or create the totals for a student
+static student_totals_t *cohort_student(cohort_t *cohort, const char *id, size_t len) {
+    if ((cohort->count + 1) * 10 > cohort->capacity * 7 && !cohort_grow(cohort))
+        return NULL;
+
+    uint64_t hash = id_hash(id, len);
+    size_t pos = hash & (cohort->capacity - 1);
+
+    while (cohort->slots[pos].student_id) {
+        student_totals_t *slot = &cohort->slots[pos];
+
+        if (slot->hash == hash && strncmp(slot->student_id, id, len) == 0 &&
+            slot->student_id[len] == '\0')
+            return slot;
+
+        pos = (pos + 1) & (cohort->capacity - 1);
+    }
+
+    const char *copy = id_store(cohort, id, len);
+    if (!copy)
+        return NULL;
+
+    student_totals_t *slot = &cohort->slots[pos];
+    *slot = (student_totals_t){.student_id = copy, .hash = hash};
+    cohort->count++;
+
+    return slot;
+}
+
+// Double the course table and reinsert every course
+static bool taken_grow(cohort_t *cohort) {
+    size_t capacity = cohort->taken_capacity ? cohort->taken_capacity * 2 : COHORT_MIN_CAPACITY;
+    cohort_course_t *taken = calloc(capacity, sizeof(cohort_course_t));
+    if (!taken)
+        return false;
+
+    for (size_t i = 0; i < cohort->taken_capacity; i++) {
+        const cohort_course_t *old = &cohort->taken[i];
+        if (!old->student_id)
+            continue;
+
+        size_t pos = old->hash & (capacity - 1);
+        while (taken[pos].student_id)
+            pos = (pos + 1) & (capacity - 1);
+
+        taken[pos] = *old;
+    }
+
+    free(cohort->taken);
+    cohort->taken = taken;
+    cohort->taken_capacity = capacity;
+
+    return true;
+}
+
+// Find or create the entry for a student's course; *found tells which
+static cohort_course_t *cohort_taken(cohort_t *cohort, const student_totals_t *student,
+                                     course_key_t key, bool *found) {
+    if ((cohort->taken_count + 1) * 10 > cohort->taken_capacity * 7 && !taken_grow(cohort))
+        return NULL;
+
+    uint64_t hash = student->hash ^ course_key_hash(key);
+    size_t pos = hash & (cohort->taken_capacity - 1);
+
+    while (cohort->taken[pos].student_id) {
+        cohort_course_t *slot = &cohort->taken[pos];
+
+        // IDs are stored once per student, so the pointer identifies one
+        if (slot->student_id == student->student_id && slot->key == key) {
+            *found = true;
+            return slot;
+        }
+
+        pos = (pos + 1) & (cohort->taken_capacity - 1);
+    }
+
+    cohort_course_t *slot = &cohort->taken[pos];
+    *slot = (cohort_course_t){.student_id = student->student_id, .hash = hash, .key = key};
+    cohort->taken_count++;
+    *found = false;
+
+    return slot;
+}
+
+// Add (sign 1) or take away (sign -1) one course from a student's totals
+static void student_apply(student_totals_t *student, const float *points, float course_weight,
+                          grade_t grade, double sign) {
+    student->courses += sign > 0 ? 1 : (size_t)-1;
+    student->credits_completed += sign * course_weight;
+    student->credits_earned += sign * ((double)points[grade] * course_weight);
+}
+
+/*
+ * Count a course toward a student, applying the duplicate policy against
+ * the courses the student already has. Returns false if out of memory.
+ */
+static bool cohort_count(cohort_t *cohort, student_totals_t *student,
+                         const course_record_t *record, load_stats_t *stats) {
+    const float *points = scale_points(cohort->scale);
+
+    if (cohort->duplicates != LOAD_DUP_RETAKES) {
+        bool found;
+        cohort_course_t *course = cohort_taken(cohort, student, record->key, &found);
+        if (!course)
+            return false;
+
+        if (found) {
+            stats->duplicates++;
+
+            if (cohort->duplicates != LOAD_DUP_LAST &&
+                (cohort->duplicates != LOAD_DUP_BEST ||
+                 points[record->grade] <= points[course->grade]))
+                return true;
+
+            student_apply(student, points, course->course_weight, course->grade, -1.0);
+            stats->records--;
+        }
+
+        course->course_weight = record->course_weight;
+        course->grade = record->grade;
+    }
+
+    student_apply(student, points, record->course_weight, record->grade, 1.0);
+    stats->records++;
+
+    return true;
+}
+
+// Aggregate a cohort file into per-student totals
+bool cohort_load(cohort_t *cohort, FILE *fptr, load_stats_t *stats) {
+    load_stats_t local = {0};
+    if (!stats)
+        stats = &local;
+    *stats = (load_stats_t){0};
+
+    INSTR_START(instr_start);
+    double start = now_seconds();
+    file_view_t view;
+
+    if (!file_view_open(&view, fptr))
+        return false;
+
+    const char *p = view.data;
+    const char *end = view.data + view.len;
+    bool ok = true;
+
+    while (p < end && ok) {
+        const char *eol = line_end(p, end);
+        const char *cur = p;
+        p = eol < end ? eol + 1 : end;
+
+        while (cur < eol && is_blank(*cur))
+            cur++;
+
+        // Skip blank lines and comments, indented or not
+        if (cur == eol || *cur == '#') {
+            stats->lines++;
+            continue;
+        }
+
+        const char *id = cur;
+        while (cur < eol && !is_blank(*cur))
+            cur++;
+
+        size_t id_len = (size_t)(cur - id);
+        if (id_len == 0 || id_len > STUDENT_ID_MAX_LEN) {
+            stats->lines++;
+            if (id_len)
+                stats->skipped++;
+            continue;
+        }
+
+        // Rest of the line is a normal course line
+        course_record_t record;
+        size_t skipped = stats->skipped;
+
+        if (!scan_course_line(cur, eol, cohort->scale, &record, stats)) {
+            if (stats->skipped == skipped)
+                stats->skipped++;  // ID with no course
+            continue;
+        }
+
+        student_totals_t *student = cohort_student(cohort, id, id_len);
+        if (!student || !cohort_count(cohort, student, &record, stats)) {
+            ok = false;
+            break;
+        }
+    }
+
+    stats->bytes = view.len;
+    file_view_close(&view);
+    stats->seconds = now_seconds() - start;
+    INSTR_END(INSTR_COHORT_LOAD, instr_start);
+
+    return ok;
+}
+
+static int compare_students(const void *a, const void *b) {
+    const student_totals_t *const *sa = a;
+    const student_totals_t *const *sb = b;
+
+    return strcmp((*sa)->student_id, (*sb)->student_id);
+}
+
+// Students sorted by ID
+const student_totals_t **cohort_sorted(const cohort_t *cohort) {
+    const student_totals_t **sorted = malloc((cohort->count ? cohort->count : 1) * sizeof(*sorted));
+    if (!sorted)
+        return NULL;
+
+    size_t n = 0;
+    for (size_t i = 0; i < cohort->capacity; i++) {
+        if (cohort->slots[i].student_id)
+            sorted[n++] = &cohort->slots[i];
+    }
+
+    qsort(sorted, n, sizeof(*sorted), compare_students);
+    return sorted;
+}
+
+double student_cgpa(const student_totals_t *student) {
+    return student->credits_completed > 0.0 ? student->credits_earned / student->credits_completed
+                                            : 0.0;
+}
+
+void cohort_free(cohort_t *cohort) {
+    id_block_t *block = cohort->ids;
+
+    while (block) {
+        id_block_t *next = block->next;
+        free(block);
+        block = next;
+    }
+
+    free(cohort->slots);
+    free(cohort->taken);
+    *cohort = (cohort_t){0};
+}
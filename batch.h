@@ -0,0 +1,85 @@
+/***********************************
+ * batch.h
+ *
+ * CGPA Calculator - cohort (multi-student) batch processing
+ *
+ * Defines:
+ * - per-student totals
+ * - hash-grouped cohort aggregation
+ *
+ * Author: Arul Rao (Vidonicle)
+ * License: MIT
+ ***********************************/
+
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "cgpa.h"
+#include "loader.h"
+
+#define STUDENT_ID_MAX_LEN 32  // Longer IDs are treated as invalid lines
+
+typedef struct {
+    const char *student_id;  // NUL-terminated, owned by the cohort
+    uint64_t hash;
+    size_t courses;
+    double credits_earned;
+    double credits_completed;
+} student_totals_t;
+
+// Block of student ID storage
+typedef struct id_block {
+    struct id_block *next;
+    size_t used;
+    char data[];
+} id_block_t;
+
+// Course a student has counted, for resolving repeated codes
+typedef struct {
+    const char *student_id;  // The student's stored ID; NULL = empty slot
+    uint64_t hash;
+    course_key_t key;
+    float course_weight;
+    uint8_t grade;  // grade_t
+} cohort_course_t;
+
+typedef struct {
+    student_totals_t *slots;  // Open-addressed table, empty slots have no ID
+    size_t capacity;          // Power of two
+    size_t count;
+    id_block_t *ids;
+    cohort_course_t *taken;  // Open-addressed (student, code) table; NULL with retakes
+    size_t taken_capacity;   // Power of two, or 0 before the first course
+    size_t taken_count;
+    const grading_scale_t *scale;  // Set before loading; NULL = built-in scale
+    load_duplicates_t duplicates;  // Set before loading; a student's repeated codes
+} cohort_t;
+
+/*
+ * Aggregate a cohort file into per-student totals.
+ * Each line is a student ID followed by a normal course line
+ * (code, weight, grade). Blank lines and '#' comments are skipped. A code
+ * a student repeats is resolved by cohort->duplicates, in file order, as
+ * load_from_file does for one transcript; stats->duplicates counts the
+ * rows dropped or replaced.
+ *
+ * Returns false on allocation or read failure.
+ */
+bool cohort_load(cohort_t *cohort, FILE *fptr, load_stats_t *stats);
+
+/*
+ * Students sorted by ID. Caller frees the array (not the entries).
+ * Returns NULL on allocation failure.
+ */
+const student_totals_t **cohort_sorted(const cohort_t *cohort);
+
+double student_cgpa(const student_totals_t *student);
+
+void cohort_free(cohort_t *cohort);
+
+#endif /* BATCH_H */
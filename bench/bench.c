@@ -0,0 +1,303 @@
+/***********************************
+ * bench.c
+ *
+ * CGPA Calculator - benchmarks for the core course operations
+ *
+ * Handles:
+ * - synthetic transcript generation
+ * - timing add / fetch / edit / delete, file loads and aggregation
+ * - ns/op, throughput and peak RSS reporting
+ *
+ * Author: Arul Rao (Vidonicle)
+ * License: MIT
+ ***********************************/
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+
+#include "aggregate.h"
+#include "cgpa.h"
+#include "courselist.h"
+#include "loader.h"
+
+#define BENCH_DEFAULT_MAX 1000000  // Largest size run without --max
+#define BENCH_LIMIT 10000000       // Largest size accepted
+#define BENCH_MIN_SECONDS 0.2      // Repeat short operations for at least this long
+
+static const float bench_weights[] = {1.0f, 0.5f, 0.25f};
+
+// Synthetic transcript: codes, weights and grades as the menu would see them
+typedef struct {
+    char (*codes)[COURSE_CODE_BUF_LEN];
+    float *weights;
+    const char **grades;
+    size_t *order;  // Random permutation for lookups
+    size_t count;
+} transcript_t;
+
+static volatile double bench_sink;  // Keeps results observable
+
+// xorshift64*: fast, reproducible, good enough for synthetic data
+static uint64_t rng_next(uint64_t *state) {
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 0x2545f4914f6cdd1dULL;
+}
+
+static bool transcript_make(transcript_t *t, size_t count, uint64_t seed) {
+    t->count = count;
+    t->codes = malloc(count * sizeof *t->codes);
+    t->weights = malloc(count * sizeof *t->weights);
+    t->grades = malloc(count * sizeof *t->grades);
+    t->order = malloc(count * sizeof *t->order);
+
+    if (!t->codes || !t->weights || !t->grades || !t->order)
+        return false;
+
+    for (size_t i = 0; i < count; i++) {
+        uint64_t r = rng_next(&seed);
+
+        for (size_t j = 0; j < 4; j++, r /= 26)
+            t->codes[i][j] = (char)('A' + r % 26);
+        snprintf(t->codes[i] + 4, COURSE_CODE_BUF_LEN - 4, "%04u", (unsigned)(r % 10000));
+
+        t->weights[i] = bench_weights[rng_next(&seed) % 3];
+        t->grades[i] = grade_to_string((grade_t)(rng_next(&seed) % GRADE_COUNT));
+        t->order[i] = i;
+    }
+
+    // Fisher-Yates
+    for (size_t i = count; i > 1; i--) {
+        size_t j = rng_next(&seed) % i;
+        size_t tmp = t->order[i - 1];
+        t->order[i - 1] = t->order[j];
+        t->order[j] = tmp;
+    }
+
+    return true;
+}
+
+static void transcript_free(transcript_t *t) {
+    free(t->codes);
+    free(t->weights);
+    free(t->grades);
+    free(t->order);
+}
+
+static long peak_rss_kb(void) {
+    struct rusage usage;
+
+    return getrusage(RUSAGE_SELF, &usage) == 0 ? usage.ru_maxrss : -1;
+}
+
+static void report(const char *op, size_t n, size_t ops, double seconds, size_t bytes) {
+    double ns = ops ? seconds * 1e9 / (double)ops : 0.0;
+    double mops = seconds > 0 ? (double)ops / seconds / 1e6 : 0.0;
+
+    printf("%-16s %10zu %10.1f %10.2f", op, n, ns, mops);
+    if (bytes)
+        printf(" %10.1f", seconds > 0 ? (double)bytes / 1e6 / seconds : 0.0);
+    else
+        printf(" %10s", "-");
+    printf(" %10ld\n", peak_rss_kb());
+}
+
+// Fill a list with every course through the menu's string API
+static bool fill(courselist_t *courses, const transcript_t *t) {
+    for (size_t i = 0; i < t->count; i++) {
+        if (!add_course(courses, t->codes[i], t->weights[i], t->grades[i]))
+            return false;
+    }
+
+    return true;
+}
+
+static bool bench_list_ops(const transcript_t *t) {
+    courselist_t courses = {0};
+    size_t n = t->count;
+
+    double start = now_seconds();
+    if (!fill(&courses, t))
+        return false;
+    report("add_course", n, n, now_seconds() - start, 0);
+
+    // Lookups in random order, repeated until the timing is stable
+    size_t ops = 0;
+    double found = 0.0;
+    start = now_seconds();
+    do {
+        for (size_t i = 0; i < n; i++)
+            found += fetch_node(&courses, t->codes[t->order[i]])->course_weight;
+        ops += n;
+    } while (now_seconds() - start < BENCH_MIN_SECONDS);
+    report("fetch_node", n, ops, now_seconds() - start, 0);
+    bench_sink = found;
+
+    // Same code, new grade: the in-place path
+    start = now_seconds();
+    for (size_t i = 0; i < n; i++) {
+        const char *code = t->codes[t->order[i]];
+        if (!edit_course(&courses, code, code, t->weights[i], t->grades[n - 1 - i]))
+            return false;
+    }
+    report("edit_course", n, n, now_seconds() - start, 0);
+
+    start = now_seconds();
+    for (size_t i = 0; i < n; i++)
+        delete_course(&courses, t->codes[t->order[i]]);
+    report("delete_course", n, n, now_seconds() - start, 0);
+
+    deconstruct(&courses);
+    return true;
+}
+
+static bool bench_aggregate(const transcript_t *t) {
+    courselist_t courses = {0};
+    cgpa_totals_t totals = {0};
+    size_t n = t->count;
+
+    if (!fill(&courses, t))
+        return false;
+
+    // Running totals: O(1) per call, so this one is timed per call
+    size_t ops = 0;
+    double start = now_seconds();
+    do {
+        totals = cgpa_current(&courses);
+        ops++;
+    } while (now_seconds() - start < BENCH_MIN_SECONDS);
+    report("cgpa_current", n, ops, now_seconds() - start, 0);
+    bench_sink = totals.cgpa;
+
+    ops = 0;
+    start = now_seconds();
+    do {
+        courses_totals(&courses, &totals);
+        ops += n;
+    } while (now_seconds() - start < BENCH_MIN_SECONDS);
+    report("courses_totals", n, ops, now_seconds() - start, 0);
+    bench_sink = totals.cgpa;
+
+    transcript_soa_t soa;
+    if (!soa_build(&soa, &courses)) {
+        deconstruct(&courses);
+        return false;
+    }
+
+    ops = 0;
+    start = now_seconds();
+    do {
+        soa_totals(&soa, &totals);
+        ops += n;
+    } while (now_seconds() - start < BENCH_MIN_SECONDS);
+    report("soa_totals", n, ops, now_seconds() - start, 0);
+    bench_sink = totals.cgpa;
+
+    soa_free(&soa);
+    deconstruct(&courses);
+    return true;
+}
+
+static bool bench_load(const transcript_t *t, size_t threads, const char *op) {
+    FILE *fptr = tmpfile();
+    if (!fptr)
+        return false;
+
+    for (size_t i = 0; i < t->count; i++)
+        fprintf(fptr, "%s %.2f %s\n", t->codes[i], t->weights[i], t->grades[i]);
+
+    if (fflush(fptr) != 0) {
+        fclose(fptr);
+        return false;
+    }
+    rewind(fptr);
+
+    courselist_t courses = {0};
+    load_stats_t stats;
+    bool ok = load_from_file_parallel(&courses, fptr, threads, LOAD_DUP_RETAKES, &stats);
+
+    if (ok)
+        report(op, t->count, stats.records, stats.seconds, stats.bytes);
+
+    deconstruct(&courses);
+    fclose(fptr);
+    return ok;
+}
+
+static void usage(void) {
+    fprintf(stderr,
+            "Usage: cgpa-bench [--max N] [--seed S] [SIZE...]\n"
+            "  Default sizes are powers of ten from 1000 to --max (default %d, at most %d).\n",
+            BENCH_DEFAULT_MAX, BENCH_LIMIT);
+}
+
+int main(int argc, char **argv) {
+    size_t sizes[16];
+    size_t size_count = 0;
+    size_t max = BENCH_DEFAULT_MAX;
+    uint64_t seed = 0x9e3779b97f4a7c15ULL;
+
+    for (int i = 1; i < argc; i++) {
+        char *endptr;
+
+        if ((strcmp(argv[i], "--max") == 0 || strcmp(argv[i], "--seed") == 0) && i + 1 < argc) {
+            unsigned long long value = strtoull(argv[i + 1], &endptr, 10);
+
+            if (*endptr != '\0' || value == 0) {
+                usage();
+                return 64;
+            }
+            if (argv[i][2] == 'm')
+                max = (size_t)value;
+            else
+                seed = value;
+            i++;
+        } else {
+            unsigned long long value = strtoull(argv[i], &endptr, 10);
+
+            if (*endptr != '\0' || value == 0 || value > BENCH_LIMIT ||
+                size_count == sizeof sizes / sizeof sizes[0]) {
+                usage();
+                return 64;
+            }
+            sizes[size_count++] = (size_t)value;
+        }
+    }
+
+    if (max > BENCH_LIMIT) {
+        usage();
+        return 64;
+    }
+
+    if (size_count == 0) {
+        for (size_t n = 1000; n <= max; n *= 10)
+            sizes[size_count++] = n;
+    }
+
+    printf("%-16s %10s %10s %10s %10s %10s\n", "op", "n", "ns/op", "Mops/s", "MB/s",
+           "peak KiB");
+
+    for (size_t i = 0; i < size_count; i++) {
+        transcript_t t = {0};
+
+        bool ok = transcript_make(&t, sizes[i], seed) && bench_list_ops(&t) &&
+                  bench_aggregate(&t) && bench_load(&t, 1, "load (1 thread)") &&
+                  bench_load(&t, 0, "load (all cores)");
+        transcript_free(&t);
+
+        if (!ok) {
+            fprintf(stderr, "cgpa-bench: out of memory or temporary file failed at n=%zu\n",
+                    sizes[i]);
+            return 71;
+        }
+    }
+
+    return 0;
+}
@@ -4,9 +4,9 @@
  * CGPA Calculator - core calculation and list management logic
  *
  * Handles:
- * - linked list integration for courses
- * - grade-to-credit conversion
- * - CGPA aggregation
+ * - balanced course index with in-order links
+ * - grade lookup and grade-to-credit conversion
+ * - CGPA aggregation, overall, per term and per code range
  *
  * Author: Arul Rao (Vidonicle)
  * License: MIT
@@ -18,256 +18,1065 @@
 #include <ctype.h>
 #include <stdbool.h>
 #include <stddef.h>
-#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-static const grade_map_t grade_map[] = {{"A+", 12.0f}, {"A", 11.0f}, {"A-", 10.0f}, {"B+", 9.0f},
-                                        {"B", 8.0f},   {"B-", 7.0f}, {"C+", 6.0f},  {"C", 5.0f},
-                                        {"C-", 4.0f},  {"D+", 3.0f}, {"D", 2.0f},   {"D-", 1.0f},
-                                        {"F", 0.0f}};
-static const size_t GRADE_MAP_LEN = sizeof grade_map / sizeof grade_map[0];
-
-// Print main menu helper to print on loop
-void print_menu(void) {
-    printf(
-        "\n =============WELCOME===============\n"
-        "  -Welcome to the CGPA Calculator\n"
-        "  -Please follow all instructions\n"
-        "  -Currently only compatible with the system\n"
-        "   used by Carleton University\n"
-        "  -V1.2.4\n"
-        " =========CGPA CALCULATOR===========");
-
-    printf(
-        "\n\n  1. Add a course\n"
-        "  2. Delete a course\n"
-        "  3. Edit a course\n"
-        "  %d. Display Courses and CGPA\n"
-        "  %d. Exit\n\n"
-        "  Enter your selection (1-%d): ",
-        MENU_DISPLAY, MENU_EXIT, MENU_COUNT);
+#include "courselist.h"
+#include "instrument.h"
+#include "scale.h"
+
+static const char *const grade_names[GRADE_COUNT] = {
+    "A+", "A", "A-", "B+", "B", "B-", "C+", "C", "C-", "D+", "D", "D-", "F"};
+
+/*
+ * Perfect hash over the two grade characters: low 3 bits of the letter
+ * and bits 1-2 of the suffix ('\0', '+', '-' map to 0, 1, 2).
+ * Each slot keeps its characters so a single load both finds and checks.
+ */
+#define GRADE_SLOT(c0, c1) ((((unsigned)(c0) & 7u) << 2) | (((unsigned)(c1) >> 1) & 3u))
+#define GRADE_SLOTS 32
+
+typedef struct {
+    unsigned char c0;
+    unsigned char c1;
+    uint8_t grade;
+} grade_slot_t;
+
+static const grade_slot_t grade_lut[GRADE_SLOTS] = {
+    [GRADE_SLOT('A', '+')] = {'A', '+', GRADE_A_PLUS},
+    [GRADE_SLOT('A', '\0')] = {'A', '\0', GRADE_A},
+    [GRADE_SLOT('A', '-')] = {'A', '-', GRADE_A_MINUS},
+    [GRADE_SLOT('B', '+')] = {'B', '+', GRADE_B_PLUS},
+    [GRADE_SLOT('B', '\0')] = {'B', '\0', GRADE_B},
+    [GRADE_SLOT('B', '-')] = {'B', '-', GRADE_B_MINUS},
+    [GRADE_SLOT('C', '+')] = {'C', '+', GRADE_C_PLUS},
+    [GRADE_SLOT('C', '\0')] = {'C', '\0', GRADE_C},
+    [GRADE_SLOT('C', '-')] = {'C', '-', GRADE_C_MINUS},
+    [GRADE_SLOT('D', '+')] = {'D', '+', GRADE_D_PLUS},
+    [GRADE_SLOT('D', '\0')] = {'D', '\0', GRADE_D},
+    [GRADE_SLOT('D', '-')] = {'D', '-', GRADE_D_MINUS},
+    [GRADE_SLOT('F', '\0')] = {'F', '\0', GRADE_F},
+};
+
+#define SLAB_MIN_NODES 64     // First slab size
+#define SLAB_MAX_NODES 65536  // Slabs double in size up to this
+
+#define BULK_EDIT_MERGE_RATIO 16  // Merge when edits * ratio >= list size
+
+#define SUBJECT_MIN_SLOTS 16  // First subject table size; grows at half full
+
+#define RADIX_BITS 12  // Key bits per radix sort pass
+#define RADIX_BUCKETS (1u << RADIX_BITS)
+
+// Pack a course code (4 letters + 4 digits, any case) into its key
+course_key_t course_key_from_code(const char *course_code) {
+    return course_key_from_chars(course_code, strlen(course_code));
 }
 
-// Fetch course from list
-coursenode_t *fetch_node(coursenode_t *courses, const char *course_code) {
-    coursenode_t *curr = courses;
+// Pack a course code of known length (not NUL-terminated)
+course_key_t course_key_from_chars(const char *course_code, size_t len) {
+    if (len != 8)
+        return COURSE_KEY_INVALID;
 
-    while (curr) {
-        if (strcmp(course_code, curr->course_code) == 0)
-            return curr;
+    course_key_t key = 0;
 
-        curr = curr->next;
+    for (size_t i = 0; i < 4; i++) {
+        int c = toupper((unsigned char)course_code[i]);
+        if (c < 'A' || c > 'Z')
+            return COURSE_KEY_INVALID;
+
+        key = (key << COURSE_KEY_LETTER_BITS) | (course_key_t)(c - 'A');
     }
 
-    return NULL;
+    unsigned number = 0;
+    for (size_t i = 4; i < 8; i++) {
+        if (!isdigit((unsigned char)course_code[i]))
+            return COURSE_KEY_INVALID;
+
+        number = number * 10 + (unsigned)(course_code[i] - '0');
+    }
+
+    return (key << COURSE_KEY_NUMBER_BITS) | number;
 }
 
-// Add course in alphanumerical order
-bool add_course(coursenode_t **courses, const char *course_code, float course_weight,
-                const char *letter_grade) {
-    coursenode_t *new_node = malloc(sizeof(coursenode_t));
-    if (!new_node)
-        return false;
+// Pad a code prefix to the lowest ('A', '0') or highest ('Z', '9') code it starts
+static course_key_t prefix_key(const char *prefix, size_t len, bool highest) {
+    char code[8];
 
-    strcpy(new_node->course_code, course_code);
-    new_node->course_weight = course_weight;
-    strcpy(new_node->letter_grade, letter_grade);
-    new_node->credits_earned = earned_credits(course_weight, letter_grade);
-    new_node->next = NULL;
+    if (len == 0 || len > sizeof code)
+        return COURSE_KEY_INVALID;
 
-    if (*courses == NULL) {
-        *courses = new_node;
+    for (size_t i = 0; i < sizeof code; i++) {
+        if (i < len)
+            code[i] = prefix[i];
+        else if (i < 4)
+            code[i] = highest ? 'Z' : 'A';
+        else
+            code[i] = highest ? '9' : '0';
+    }
 
-        return true;
+    return course_key_from_chars(code, sizeof code);
+}
+
+bool course_key_range_from_string(const char *spec, course_key_t *first, course_key_t *last) {
+    return course_key_range_from_chars(spec, strlen(spec), first, last);
+}
+
+// Key range of a prefix, or of "FIRST-LAST" prefixes
+bool course_key_range_from_chars(const char *spec, size_t len, course_key_t *first,
+                                 course_key_t *last) {
+    const char *dash = memchr(spec, '-', len);
+    size_t first_len = dash ? (size_t)(dash - spec) : len;
+
+    *first = prefix_key(spec, first_len, false);
+    *last = dash ? prefix_key(dash + 1, len - first_len - 1, true) : prefix_key(spec, len, true);
+
+    return *first != COURSE_KEY_INVALID && *last != COURSE_KEY_INVALID && *first <= *last;
+}
+
+// Unpack a key into an upper-case course code (needs COURSE_CODE_BUF_LEN)
+void course_key_to_code(course_key_t key, char *course_code) {
+    unsigned number = COURSE_KEY_NUMBER(key);
+    course_key_t subject = COURSE_KEY_SUBJECT(key);
+
+    for (size_t i = 4; i-- > 0;) {
+        course_code[i] = (char)('A' + (subject & ((1u << COURSE_KEY_LETTER_BITS) - 1)));
+        subject >>= COURSE_KEY_LETTER_BITS;
     }
 
-    coursenode_t *prev = NULL;
-    coursenode_t *curr = *courses;
+    for (size_t i = 8; i-- > 4;) {
+        course_code[i] = (char)('0' + number % 10);
+        number /= 10;
+    }
+
+    course_code[8] = '\0';
+}
+
+// Mix key bits for hash tables (keys only differ in low bits)
+uint64_t course_key_hash(course_key_t key) {
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ULL;
+    key ^= key >> 33;
+
+    return key;
+}
+
+static const char term_seasons[TERM_SEASONS] = {'W', 'S', 'F'};  // In calendar order
+
+// Parse a term such as F2024 (any case)
+term_t term_from_string(const char *term) {
+    return term_from_chars(term, strlen(term));
+}
+
+// Parse a term of known length (not NUL-terminated)
+term_t term_from_chars(const char *term, size_t len) {
+    if (len != TERM_BUF_LEN - 1)
+        return TERM_NONE;
 
-    while (curr && strcmp(curr->course_code, course_code) < 0) {
-        prev = curr;
-        curr = curr->next;
+    int c = toupper((unsigned char)term[0]);
+    unsigned season = 0;
+
+    while (season < TERM_SEASONS && term_seasons[season] != c)
+        season++;
+    if (season == TERM_SEASONS)
+        return TERM_NONE;
+
+    unsigned year = 0;
+    for (size_t i = 1; i < len; i++) {
+        if (!isdigit((unsigned char)term[i]))
+            return TERM_NONE;
+        year = year * 10 + (unsigned)(term[i] - '0');
     }
 
-    if (prev == NULL) {
-        new_node->next = *courses;
-        *courses = new_node;
+    if (year < TERM_FIRST_YEAR || year > TERM_LAST_YEAR)
+        return TERM_NONE;
+
+    return (term_t)((year - TERM_FIRST_YEAR) * TERM_SEASONS + season + 1);
+}
+
+void term_to_string(term_t term, char *buf) {
+    if (term == TERM_NONE || term > TERM_COUNT) {
+        buf[0] = '\0';
+        return;
+    }
+
+    unsigned year = TERM_FIRST_YEAR + (unsigned)(term - 1) / TERM_SEASONS;
+
+    buf[0] = term_seasons[(term - 1) % TERM_SEASONS];
+    for (size_t i = 4; i > 0; i--, year /= 10)
+        buf[i] = (char)('0' + year % 10);
+    buf[5] = '\0';
+}
+
+// Height of an index subtree (empty subtree is 0)
+static int node_height(const coursenode_t *node) {
+    return node ? node->height : 0;
+}
+
+static void update_height(coursenode_t *node) {
+    int left_h = node_height(node->left);
+    int right_h = node_height(node->right);
+
+    node->height = (left_h > right_h ? left_h : right_h) + 1;
+}
+
+static coursenode_t *rotate_right(coursenode_t *node) {
+    coursenode_t *pivot = node->left;
+
+    node->left = pivot->right;
+    pivot->right = node;
+    update_height(node);
+    update_height(pivot);
+
+    return pivot;
+}
+
+static coursenode_t *rotate_left(coursenode_t *node) {
+    coursenode_t *pivot = node->right;
+
+    node->right = pivot->left;
+    pivot->left = node;
+    update_height(node);
+    update_height(pivot);
+
+    return pivot;
+}
+
+// Restore AVL balance at a subtree root and return the new root
+static coursenode_t *rebalance(coursenode_t *node) {
+    update_height(node);
+    int balance = node_height(node->left) - node_height(node->right);
+
+    if (balance > 1) {
+        if (node_height(node->left->left) < node_height(node->left->right))
+            node->left = rotate_left(node->left);
+        return rotate_right(node);
+    }
+
+    if (balance < -1) {
+        if (node_height(node->right->right) < node_height(node->right->left))
+            node->right = rotate_right(node->right);
+        return rotate_left(node);
+    }
+
+    return node;
+}
+
+// Insert node before any equal codes, recording its in-order neighbours
+static coursenode_t *index_insert(coursenode_t *root, coursenode_t *node, coursenode_t **prev,
+                                  coursenode_t **next) {
+    if (!root)
+        return node;
+
+    if (node->key <= root->key) {
+        *next = root;
+        root->left = index_insert(root->left, node, prev, next);
     } else {
-        new_node->next = curr;
-        prev->next = new_node;
+        *prev = root;
+        root->right = index_insert(root->right, node, prev, next);
     }
 
-    return true;
+    return rebalance(root);
 }
 
-// Delete node given by course code
-void delete_course(coursenode_t **courses, const char *course_code) {
-    coursenode_t *curr = *courses;
-    coursenode_t *prev = NULL;
+// Find first course in order with the given code
+static coursenode_t *index_find(coursenode_t *root, course_key_t key) {
+    coursenode_t *found = NULL;
 
-    while (curr) {
-        if (strcmp(curr->course_code, course_code) == 0) {
-            if (prev)
-                prev->next = curr->next;
-            else
-                *courses = curr->next;
+    while (root) {
+        if (key <= root->key) {
+            if (key == root->key)
+                found = root;
+            root = root->left;
+        } else {
+            root = root->right;
+        }
+    }
 
-            free(curr);
-            return;
+    return found;
+}
+
+// Find first course in order with a code of key or above
+static coursenode_t *index_lower_bound(coursenode_t *root, course_key_t key) {
+    coursenode_t *found = NULL;
+
+    while (root) {
+        if (key <= root->key) {
+            found = root;
+            root = root->left;
+        } else {
+            root = root->right;
         }
+    }
 
-        prev = curr;
-        curr = curr->next;
+    return found;
+}
+
+// Detach leftmost node of a subtree
+static coursenode_t *index_remove_min(coursenode_t *root, coursenode_t **min) {
+    if (!root->left) {
+        *min = root;
+        return root->right;
     }
+
+    root->left = index_remove_min(root->left, min);
+    return rebalance(root);
 }
 
-bool edit_course(coursenode_t **courses, const char *course_code_old, const char *course_code_new,
-                 float course_weight_new, const char *letter_grade_new) {
-    delete_course(courses, course_code_old);
-    return add_course(courses, course_code_new, course_weight_new, letter_grade_new);
+// Remove target from subtree; target must be the first course with its code
+static coursenode_t *index_remove(coursenode_t *root, coursenode_t *target) {
+    if (root == target) {
+        if (!root->left)
+            return root->right;
+        if (!root->right)
+            return root->left;
+
+        coursenode_t *succ;
+        coursenode_t *right = index_remove_min(root->right, &succ);
+        succ->left = root->left;
+        succ->right = right;
+        return rebalance(succ);
+    }
+
+    if (target->key <= root->key)
+        root->left = index_remove(root->left, target);
+    else
+        root->right = index_remove(root->right, target);
+
+    return rebalance(root);
 }
 
-// Load courses from file
-bool load_from_file(coursenode_t **courses, FILE *fptr) {
-    char line[256];
+// Look up a grade by its letter and suffix characters
+static grade_t grade_lookup(unsigned char c0, unsigned char c1) {
+    const grade_slot_t *slot = &grade_lut[GRADE_SLOT(c0, c1)];
 
-    // Loop through each line of file
-    while (fgets(line, sizeof(line), fptr)) {
-        if (line[0] == '\n' || line[0] == '#')
-            continue;  // Skip comments
+    // Unused slots are zeroed, so a '\0' letter never matches
+    return (slot->c0 == c0 && slot->c1 == c1 && c0 != '\0') ? (grade_t)slot->grade
+                                                            : GRADE_INVALID;
+}
 
-        // Default values
-        char course_code[COURSE_CODE_BUF_LEN] = {0};
-        float course_weight = 1.0f;
-        char letter_grade[LETTER_GRADE_BUF_LEN] = "F";
+// Parse a NUL-terminated letter grade
+grade_t grade_from_string(const char *letter_grade) {
+    if (letter_grade[0] == '\0')
+        return GRADE_INVALID;
+    if (letter_grade[1] != '\0' && letter_grade[2] != '\0')
+        return GRADE_INVALID;
 
-        char *tok_entptr;
-        char *tok = strtok_r(line, " \t\n", &tok_entptr);
+    return grade_lookup((unsigned char)letter_grade[0], (unsigned char)letter_grade[1]);
+}
 
-        // Skip if course code is not present
-        if (!tok)
-            continue;
-        if (!validate_course_code(tok))
-            continue;
+// Parse a letter grade of known length (not NUL-terminated)
+grade_t grade_from_chars(const char *letter_grade, size_t len) {
+    if (len == 1)
+        return grade_lookup((unsigned char)letter_grade[0], '\0');
+    if (len == 2)
+        return grade_lookup((unsigned char)letter_grade[0], (unsigned char)letter_grade[1]);
 
-        strcpy(course_code, tok);
+    return GRADE_INVALID;
+}
 
-        // Get other fields for course
-        while ((tok = strtok_r(NULL, " \t\n", &tok_entptr)) != NULL) {
-            // Get course weight
-            char *w_endptr;
-            float weight = strtof(tok, &w_endptr);
-            if (w_endptr != tok && *w_endptr == '\0') {
-                course_weight = weight;
-                continue;
-            }
+const char *grade_to_string(grade_t grade) {
+    return grade < GRADE_COUNT ? grade_names[grade] : "";
+}
 
-            // Get letter grade
-            if (validate_letter_grade(tok)) {
-                strcpy(letter_grade, tok);
-                continue;
-            }
+// Points on the built-in scale
+float grade_points(grade_t grade) {
+    return grade < GRADE_COUNT ? scale_points(NULL)[grade] : 0.0f;
+}
+
+// Add value to a compensated sum
+static void sum_add(cgpa_sum_t *acc, double value) {
+    double t = acc->sum + value;
+
+    if ((acc->sum >= 0 ? acc->sum : -acc->sum) >= (value >= 0 ? value : -value))
+        acc->comp += (acc->sum - t) + value;
+    else
+        acc->comp += (value - t) + acc->sum;
+
+    acc->sum = t;
+}
+
+// Make sure the term index exists before a course with a term goes in
+static bool terms_reserve(courselist_t *courses) {
+    if (!courses->terms)
+        courses->terms = calloc(1, sizeof *courses->terms);
+
+    return courses->terms != NULL;
+}
+
+// Fenwick point update: add a node's credits to its term
+static void terms_apply(term_index_t *terms, const coursenode_t *node, double sign) {
+    uint32_t courses = sign > 0 ? 1u : UINT32_MAX;  // +1 or -1, wrapping
+
+    for (size_t i = node->term; i <= TERM_COUNT; i += i & (~i + 1)) {
+        sum_add(&terms->credits_earned[i], sign * node->credits_earned);
+        sum_add(&terms->credits_completed[i], sign * node->course_weight);
+        terms->courses[i] += courses;
+
+        // A node whose terms hold no courses sums to exactly zero
+        if (terms->courses[i] == 0) {
+            terms->credits_earned[i] = (cgpa_sum_t){0};
+            terms->credits_completed[i] = (cgpa_sum_t){0};
         }
+    }
+}
+
+// Fenwick prefix sum over terms 1..term
+static cgpa_totals_t terms_prefix(const term_index_t *terms, term_t term, size_t *count) {
+    cgpa_sum_t earned = {0}, completed = {0};
+    uint32_t courses = 0;
 
-        if (!add_course(courses, course_code, course_weight, letter_grade))
-            return false;  // Exits on malloc failure
+    for (size_t i = term; i > 0; i -= i & (~i + 1)) {
+        sum_add(&earned, terms->credits_earned[i].sum);
+        sum_add(&earned, terms->credits_earned[i].comp);
+        sum_add(&completed, terms->credits_completed[i].sum);
+        sum_add(&completed, terms->credits_completed[i].comp);
+        courses += terms->courses[i];
     }
 
-    return true;
+    *count = courses;
+    return (cgpa_totals_t){
+        .credits_earned = earned.sum + earned.comp,
+        .credits_completed = completed.sum + completed.comp,
+    };
 }
 
-// Calculate earned credits depending on course weight and letter grade
-float earned_credits(float course_weight, const char *letter_grade) {
-    for (size_t i = 0; i < GRADE_MAP_LEN; i++) {
-        if (strcmp(letter_grade, grade_map[i].grade) == 0)
-            return (grade_map[i].value * course_weight);
+// Slot of a subject, or the empty slot where it would go
+static subject_totals_t *subject_slot(const subject_index_t *subjects, uint32_t subject) {
+    size_t mask = subjects->capacity - 1;
+    size_t i = (size_t)course_key_hash((course_key_t)subject << COURSE_KEY_NUMBER_BITS) & mask;
+
+    while (subjects->slots[i].subject != 0 && subjects->slots[i].subject != subject + 1)
+        i = (i + 1) & mask;
+
+    return &subjects->slots[i];
+}
+
+// Double the subject table, rehashing every subject into it
+static bool subjects_grow(subject_index_t *subjects) {
+    subject_index_t grown = {
+        .capacity = subjects->capacity ? subjects->capacity * 2 : SUBJECT_MIN_SLOTS,
+        .used = subjects->used,
+    };
+
+    grown.slots = calloc(grown.capacity, sizeof *grown.slots);
+    if (!grown.slots)
+        return false;
+
+    for (size_t i = 0; i < subjects->capacity; i++) {
+        if (subjects->slots[i].subject != 0)
+            *subject_slot(&grown, subjects->slots[i].subject - 1) = subjects->slots[i];
     }
 
-    return 0.0f;
+    free(subjects->slots);
+    *subjects = grown;
+    return true;
 }
 
-// Print grades and formats column sections
-void display_grades(coursenode_t *courses) {
-    float accum_credits = 0.0f;
-    float accum_weight = 0.0f;
+// Make sure a course's subject has a slot before the course goes in
+static bool subjects_reserve(courselist_t *courses, course_key_t key) {
+    subject_index_t *subjects = &courses->subjects;
+    uint32_t subject = (uint32_t)COURSE_KEY_SUBJECT(key);
 
-    printf(SEPERATOR1 "  Course Code  Course Weight  Letter Grade  Credits Earned\n");
+    if (subjects->capacity && subject_slot(subjects, subject)->subject != 0)
+        return true;
+    if ((subjects->used + 1) * 2 > subjects->capacity && !subjects_grow(subjects))
+        return false;
 
-    for (coursenode_t *curr = courses; curr; curr = curr->next) {
-        int grade_w = (curr->letter_grade[1] == '\0') ? 11 : 12;
-        int credit_w = (curr->letter_grade[1] == '\0') ? 16 : 15;
+    subject_slot(subjects, subject)->subject = subject + 1;
+    subjects->used++;
+    return true;
+}
 
-        printf("  %-12s %4.2f %*s %*.2f\n", curr->course_code, curr->course_weight, grade_w,
-               curr->letter_grade, credit_w, curr->credits_earned);
+// Fold a node into (sign 1) or out of (sign -1) its subject's totals
+static void subjects_apply(subject_index_t *subjects, const coursenode_t *node, double sign) {
+    subject_totals_t *slot = subject_slot(subjects, (uint32_t)COURSE_KEY_SUBJECT(node->key));
 
-        accum_credits += curr->credits_earned;
-        accum_weight += curr->course_weight;
+    slot->courses += sign > 0 ? 1u : UINT32_MAX;  // +1 or -1, wrapping
+    sum_add(&slot->credits_earned, sign * node->credits_earned);
+    sum_add(&slot->credits_completed, sign * node->course_weight);
+
+    // As for the whole list, a subject without courses sums to exactly zero
+    if (slot->courses == 0) {
+        slot->credits_earned = (cgpa_sum_t){0};
+        slot->credits_completed = (cgpa_sum_t){0};
     }
+}
 
-    printf(
-        "\n\n  Total Credits Earned: %4.2f"
-        "\n  Total Credits Completed: %4.2f"
-        "\n\n  Current CGPA: %4.2f\n" SEPERATOR2,
-        accum_credits, accum_weight, accum_weight > 0 ? accum_credits / accum_weight : 0.0f);
+// Fold a node into (sign 1) or out of (sign -1) the running totals
+static void totals_apply(courselist_t *courses, const coursenode_t *node, double sign) {
+    sum_add(&courses->credits_earned, sign * node->credits_earned);
+    sum_add(&courses->credits_completed, sign * node->course_weight);
+    subjects_apply(&courses->subjects, node, sign);
+
+    if (node->term != TERM_NONE)
+        terms_apply(courses->terms, node, sign);
+
+    // An empty list has exactly zero totals, whatever rounding came before
+    if (courses->count == 0) {
+        courses->credits_earned = (cgpa_sum_t){0};
+        courses->credits_completed = (cgpa_sum_t){0};
+        if (courses->terms)
+            memset(courses->terms, 0, sizeof *courses->terms);
+    }
 }
 
-// Check for existing courses
-bool check_courses(coursenode_t *courses, const char *course_code) {
-    coursenode_t *curr = courses;
+// Take a node from the free list or the current slab, growing the arena if needed
+static coursenode_t *node_alloc(courselist_t *courses) {
+    if (courses->free_nodes) {
+        coursenode_t *node = courses->free_nodes;
+        courses->free_nodes = node->next;
+        return node;
+    }
 
-    while (curr) {
-        if (strcmp(curr->course_code, course_code) == 0)
-            return true;
+    course_slab_t *slab = courses->slabs;
 
-        curr = curr->next;
+    if (!slab || slab->used == slab->capacity) {
+        size_t capacity = slab ? slab->capacity * 2 : SLAB_MIN_NODES;
+        if (capacity > SLAB_MAX_NODES)
+            capacity = SLAB_MAX_NODES;
+
+        course_slab_t *new_slab = malloc(sizeof(course_slab_t) + capacity * sizeof(coursenode_t));
+        if (!new_slab)
+            return NULL;
+
+        new_slab->next = slab;
+        new_slab->used = 0;
+        new_slab->capacity = capacity;
+        courses->slabs = slab = new_slab;
     }
 
-    return false;
+    return &slab->nodes[slab->used++];
+}
+
+// Return a node to the free list for reuse
+static void node_release(courselist_t *courses, coursenode_t *node) {
+    node->next = courses->free_nodes;
+    courses->free_nodes = node;
+}
+
+// Fetch the first course with the given key
+coursenode_t *fetch_node_key(const courselist_t *courses, course_key_t key) {
+    INSTR_START(start);
+    coursenode_t *node = index_find(courses->root, key);
+    INSTR_END(INSTR_FETCH, start);
+
+    return node;
+}
+
+// Fetch course from list
+coursenode_t *fetch_node(const courselist_t *courses, const char *course_code) {
+    return fetch_node_key(courses, course_key_from_code(course_code));
+}
+
+// First course with a code of key or above
+coursenode_t *fetch_node_from(const courselist_t *courses, course_key_t key) {
+    return index_lower_bound(courses->root, key);
+}
+
+// Link a detached node into the index and in-order chain
+static void index_link(courselist_t *courses, coursenode_t *node) {
+    node->height = 1;
+    node->left = node->right = NULL;
+
+    coursenode_t *prev = NULL;
+    coursenode_t *next = NULL;
+    courses->root = index_insert(courses->root, node, &prev, &next);
+
+    node->prev = prev;
+    node->next = next;
+    if (prev)
+        prev->next = node;
+    else
+        courses->head = node;
+    if (next)
+        next->prev = node;
+}
+
+// Detach a node (the first with its code) from the index and in-order chain
+static void index_unlink(courselist_t *courses, coursenode_t *node) {
+    courses->root = index_remove(courses->root, node);
+
+    if (node->prev)
+        node->prev->next = node->next;
+    else
+        courses->head = node->next;
+    if (node->next)
+        node->next->prev = node->prev;
 }
 
-// Check validation for course code
-bool validate_course_code(char *course_code) {
-    if (!(strlen(course_code) == 8)) {
+// Set a node's weight and grade, keeping credits in step with the list's scale
+static void node_set_grade(const courselist_t *courses, coursenode_t *node, float course_weight,
+                           grade_t grade) {
+    node->course_weight = course_weight;
+    node->grade = (uint8_t)grade;
+    node->credits_earned =
+        (grade < GRADE_COUNT ? scale_points(courses->scale)[grade] : 0.0f) * course_weight;
+}
+
+// Insert a parsed course in alphanumerical order
+static bool insert_course(courselist_t *courses, course_key_t key, float course_weight,
+                          grade_t grade, term_t term) {
+    if (term != TERM_NONE && !terms_reserve(courses))
+        return false;
+    if (!subjects_reserve(courses, key))
         return false;
+
+    coursenode_t *new_node = node_alloc(courses);
+    if (!new_node)
+        return false;
+
+    new_node->key = key;
+    new_node->term = term;
+    node_set_grade(courses, new_node, course_weight, grade);
+    index_link(courses, new_node);
+
+    courses->count++;
+    totals_apply(courses, new_node, 1.0);
+    return true;
+}
+
+// Add course in alphanumerical order
+bool add_course(courselist_t *courses, const char *course_code, float course_weight,
+                const char *letter_grade) {
+    INSTR_START(start);
+    bool ok = insert_course(courses, course_key_from_code(course_code), course_weight,
+                            grade_from_string(letter_grade), TERM_NONE);
+    INSTR_END(INSTR_ADD, start);
+
+    return ok;
+}
+
+// Add an already parsed course
+bool add_course_key(courselist_t *courses, course_key_t key, float course_weight, grade_t grade) {
+    return insert_course(courses, key, course_weight, grade, TERM_NONE);
+}
+
+// Add a parsed course, term included
+bool add_course_record(courselist_t *courses, const course_record_t *record) {
+    return insert_course(courses, record->key, record->course_weight, (grade_t)record->grade,
+                         record->term);
+}
+
+/*
+ * Stable LSD radix sort of records by key (3 passes cover the 34 key bits).
+ * scratch must hold count records. Passes where every key shares the
+ * digit are skipped.
+ */
+void sort_course_records(course_record_t *records, course_record_t *scratch, size_t count) {
+    course_record_t *src = records;
+    course_record_t *dst = scratch;
+
+    for (unsigned shift = 0; shift < COURSE_KEY_BITS; shift += RADIX_BITS) {
+        size_t buckets[RADIX_BUCKETS] = {0};
+
+        for (size_t i = 0; i < count; i++)
+            buckets[(src[i].key >> shift) & (RADIX_BUCKETS - 1)]++;
+
+        if (count == 0 || buckets[(src[0].key >> shift) & (RADIX_BUCKETS - 1)] == count)
+            continue;
+
+        size_t offset = 0;
+        for (size_t b = 0; b < RADIX_BUCKETS; b++) {
+            size_t n = buckets[b];
+            buckets[b] = offset;
+            offset += n;
+        }
+
+        for (size_t i = 0; i < count; i++)
+            dst[buckets[(src[i].key >> shift) & (RADIX_BUCKETS - 1)]++] = src[i];
+
+        course_record_t *tmp = src;
+        src = dst;
+        dst = tmp;
     }
 
-    for (size_t i = 0; i < 4; i++) {
-        if (!isalpha(course_code[i]))
-            return false;
+    if (src != records)
+        memcpy(records, src, count * sizeof(course_record_t));
+}
+
+// Build a balanced subtree from the next n nodes of an in-order chain
+static coursenode_t *index_build(coursenode_t **chain, size_t n) {
+    if (n == 0)
+        return NULL;
+
+    coursenode_t *left = index_build(chain, n / 2);
+    coursenode_t *root = *chain;
+    *chain = root->next;
+
+    root->left = left;
+    root->right = index_build(chain, n - n / 2 - 1);
+    update_height(root);
+
+    return root;
+}
 
-        course_code[i] = (char)toupper((unsigned char)course_code[i]);
+/*
+ * Merge key-sorted records into the list and rebuild the index in O(n).
+ * Ends in the same order as calling add_course_key on each record in
+ * turn: records sharing a code go before existing ones, newest first.
+ */
+static bool splice_sorted(courselist_t *courses, const course_record_t *records, size_t count) {
+    for (size_t i = 0; i < count && !courses->terms; i++) {
+        if (records[i].term != TERM_NONE && !terms_reserve(courses))
+            return false;
     }
 
-    for (size_t i = 4; i < 8; i++) {
-        if (!isdigit(course_code[i]))
+    // Records are sorted, so each subject is reserved once
+    for (size_t i = 0; i < count; i++) {
+        bool new_subject =
+            i == 0 || COURSE_KEY_SUBJECT(records[i].key) != COURSE_KEY_SUBJECT(records[i - 1].key);
+
+        if (new_subject && !subjects_reserve(courses, records[i].key))
             return false;
     }
 
+    coursenode_t *existing = courses->head;
+    coursenode_t *head = NULL;
+    coursenode_t *tail = NULL;
+
+    for (size_t i = 0; i < count;) {
+        course_key_t key = records[i].key;
+        size_t group_end = i;
+
+        while (group_end < count && records[group_end].key == key)
+            group_end++;
+
+        // Existing courses with smaller codes come first
+        while (existing && existing->key < key) {
+            coursenode_t *next = existing->next;
+            existing->prev = tail;
+            if (tail)
+                tail->next = existing;
+            else
+                head = existing;
+            tail = existing;
+            existing = next;
+        }
+
+        for (size_t j = group_end; j-- > i;) {
+            coursenode_t *node = node_alloc(courses);
+            if (!node) {
+                // Keep the list usable: splice the unmerged tail back on
+                if (tail)
+                    tail->next = existing;
+                else
+                    head = existing;
+                if (existing)
+                    existing->prev = tail;
+                courses->head = head;
+                coursenode_t *chain = head;
+                courses->root = index_build(&chain, courses->count);
+                return false;
+            }
+
+            node->key = records[j].key;
+            node->term = records[j].term;
+            node_set_grade(courses, node, records[j].course_weight, (grade_t)records[j].grade);
+
+            node->prev = tail;
+            if (tail)
+                tail->next = node;
+            else
+                head = node;
+            tail = node;
+            courses->count++;
+            totals_apply(courses, node, 1.0);
+        }
+
+        i = group_end;
+    }
+
+    if (tail)
+        tail->next = existing;
+    else
+        head = existing;
+    if (existing)
+        existing->prev = tail;
+
+    courses->head = head;
+    coursenode_t *chain = head;
+    courses->root = index_build(&chain, courses->count);
+
     return true;
 }
 
-// Check validation for letter grade
-bool validate_letter_grade(const char *letter_grade) {
-    for (size_t i = 0; i < GRADE_MAP_LEN; i++) {
-        if (strcmp(letter_grade, grade_map[i].grade) == 0)
-            return true;
+bool add_courses_sorted(courselist_t *courses, const course_record_t *records, size_t count) {
+    INSTR_START(start);
+    bool ok = splice_sorted(courses, records, count);
+    INSTR_END(INSTR_ADD_BULK, start);
+
+    return ok;
+}
+
+// Delete the first course with the given key
+void delete_course_key(courselist_t *courses, course_key_t key) {
+    INSTR_START(start);
+    coursenode_t *node = index_find(courses->root, key);
+
+    if (node) {
+        index_unlink(courses, node);
+
+        courses->count--;
+        totals_apply(courses, node, -1.0);
+        node_release(courses, node);
+    }
+
+    INSTR_END(INSTR_DELETE, start);
+}
+
+// Delete node given by course code
+void delete_course(courselist_t *courses, const char *course_code) {
+    delete_course_key(courses, course_key_from_code(course_code));
+}
+
+// Update a course in place; it only moves in the index if its code changes
+static void edit_node(courselist_t *courses, coursenode_t *node, course_key_t key,
+                      float course_weight, grade_t grade) {
+    totals_apply(courses, node, -1.0);
+
+    if (key != node->key) {
+        index_unlink(courses, node);
+        node->key = key;
+        index_link(courses, node);
+    }
+
+    node_set_grade(courses, node, course_weight, grade);
+    totals_apply(courses, node, 1.0);
+}
+
+// Edit a course by key; adds it if the old key is not in the list
+bool edit_course_key(courselist_t *courses, course_key_t key_old, course_key_t key_new,
+                     float course_weight_new, grade_t grade_new) {
+    INSTR_START(start);
+    coursenode_t *node = index_find(courses->root, key_old);
+    bool ok = true;
+
+    if (!node)
+        ok = add_course_key(courses, key_new, course_weight_new, grade_new);
+    else if (!subjects_reserve(courses, key_new))
+        ok = false;
+    else
+        edit_node(courses, node, key_new, course_weight_new, grade_new);
+
+    INSTR_END(INSTR_EDIT, start);
+    return ok;
+}
+
+// Edit a course; adds it if the old code is not in the list
+bool edit_course(courselist_t *courses, const char *course_code_old, const char *course_code_new,
+                 float course_weight_new, const char *letter_grade_new) {
+    return edit_course_key(courses, course_key_from_code(course_code_old),
+                           course_key_from_code(course_code_new), course_weight_new,
+                           grade_from_string(letter_grade_new));
+}
+
+// Apply one bulk edit record, honouring the "keep" sentinels
+static void apply_edit(courselist_t *courses, coursenode_t *node, const course_record_t *edit) {
+    float course_weight = edit->course_weight < 0.0f ? node->course_weight : edit->course_weight;
+    grade_t grade = edit->grade >= GRADE_COUNT ? (grade_t)node->grade : (grade_t)edit->grade;
+
+    edit_node(courses, node, node->key, course_weight, grade);
+}
+
+/*
+ * Apply weight / grade changes to the first course with each key.
+ * Large batches are sorted and merged against the list in one pass;
+ * small ones (or if sorting cannot get memory) use index lookups.
+ */
+static size_t apply_edits(courselist_t *courses, course_record_t *edits, size_t count) {
+    size_t applied = 0;
+    course_record_t *scratch = NULL;
+
+    if (count * BULK_EDIT_MERGE_RATIO >= courses->count)
+        scratch = malloc((count ? count : 1) * sizeof(course_record_t));
+
+    if (!scratch) {
+        for (size_t i = 0; i < count; i++) {
+            coursenode_t *node = index_find(courses->root, edits[i].key);
+            if (node) {
+                apply_edit(courses, node, &edits[i]);
+                applied++;
+            }
+        }
+
+        return applied;
+    }
+
+    // Stable sort keeps repeated keys in order, so the last edit wins
+    sort_course_records(edits, scratch, count);
+    free(scratch);
+
+    coursenode_t *curr = courses->head;
+
+    for (size_t i = 0; i < count && curr; i++) {
+        while (curr && curr->key < edits[i].key)
+            curr = curr->next;
+
+        if (curr && curr->key == edits[i].key) {
+            apply_edit(courses, curr, &edits[i]);
+            applied++;
+        }
+    }
+
+    return applied;
+}
+
+size_t edit_courses(courselist_t *courses, course_record_t *edits, size_t count) {
+    INSTR_START(start);
+    size_t applied = apply_edits(courses, edits, count);
+    INSTR_END(INSTR_EDIT_BULK, start);
+
+    return applied;
+}
+
+// Calculate earned credits depending on course weight and letter grade
+float earned_credits(float course_weight, const char *letter_grade) {
+    return grade_points(grade_from_string(letter_grade)) * course_weight;
+}
+
+// Current totals from the running sums, in constant time
+cgpa_totals_t cgpa_current(const courselist_t *courses) {
+    cgpa_totals_t totals = {
+        .credits_earned = courses->credits_earned.sum + courses->credits_earned.comp,
+        .credits_completed = courses->credits_completed.sum + courses->credits_completed.comp,
+    };
+
+    totals.cgpa = totals.credits_completed > 0.0 ? totals.credits_earned / totals.credits_completed
+                                                 : 0.0;
+    return totals;
+}
+
+// Totals for one term: the difference of two prefix sums
+cgpa_totals_t cgpa_term(const courselist_t *courses, term_t term, size_t *count) {
+    size_t local;
+    if (!count)
+        count = &local;
+    *count = 0;
+
+    if (!courses->terms || term == TERM_NONE || term > TERM_COUNT)
+        return (cgpa_totals_t){0};
+
+    size_t before;
+    cgpa_totals_t totals = terms_prefix(courses->terms, term, count);
+    cgpa_totals_t prior = terms_prefix(courses->terms, (term_t)(term - 1), &before);
+
+    *count -= before;
+    if (*count == 0)
+        return (cgpa_totals_t){0};
+
+    totals.credits_earned -= prior.credits_earned;
+    totals.credits_completed -= prior.credits_completed;
+    totals.cgpa = totals.credits_completed > 0.0 ? totals.credits_earned / totals.credits_completed
+                                                 : 0.0;
+    return totals;
+}
+
+// Totals for every term up to and including term
+cgpa_totals_t cgpa_through_term(const courselist_t *courses, term_t term, size_t *count) {
+    size_t local;
+    if (!count)
+        count = &local;
+    *count = 0;
+
+    if (!courses->terms || term == TERM_NONE)
+        return (cgpa_totals_t){0};
+    if (term > TERM_COUNT)
+        term = TERM_COUNT;
+
+    cgpa_totals_t totals = terms_prefix(courses->terms, term, count);
+    if (*count == 0)
+        return (cgpa_totals_t){0};
+
+    totals.cgpa = totals.credits_completed > 0.0 ? totals.credits_earned / totals.credits_completed
+                                                 : 0.0;
+    return totals;
+}
+
+/*
+ * Totals for codes first..last. Walks the subjects the range touches:
+ * one it covers whole is a table lookup plus an index probe to skip past
+ * it; courses of a subject it cuts through are summed one by one.
+ */
+cgpa_totals_t cgpa_range(const courselist_t *courses, course_key_t first, course_key_t last,
+                         size_t *count) {
+    const course_key_t subject_span = (course_key_t)1 << COURSE_KEY_NUMBER_BITS;
+    cgpa_totals_t totals = {0};
+    size_t local;
+    if (!count)
+        count = &local;
+    *count = 0;
+
+    const coursenode_t *node = index_lower_bound(courses->root, first);
+
+    while (node && node->key <= last) {
+        uint32_t subject = (uint32_t)COURSE_KEY_SUBJECT(node->key);
+        course_key_t subject_first = (course_key_t)subject << COURSE_KEY_NUMBER_BITS;
+        course_key_t subject_last = subject_first + subject_span - 1;
+
+        if (first <= subject_first && subject_last <= last) {
+            const subject_totals_t *slot = subject_slot(&courses->subjects, subject);
+
+            totals.credits_earned += slot->credits_earned.sum + slot->credits_earned.comp;
+            totals.credits_completed += slot->credits_completed.sum + slot->credits_completed.comp;
+            *count += slot->courses;
+            node = index_lower_bound(courses->root, subject_last + 1);
+            continue;
+        }
+
+        course_key_t end = subject_last < last ? subject_last : last;
+
+        for (; node && node->key <= end; node = node->next) {
+            totals.credits_earned += node->credits_earned;
+            totals.credits_completed += node->course_weight;
+            (*count)++;
+        }
     }
 
-    return false;
+    totals.cgpa = totals.credits_completed > 0.0 ? totals.credits_earned / totals.credits_completed
+                                                 : 0.0;
+    return totals;
+}
+
+// Check for existing courses
+bool check_courses(const courselist_t *courses, const char *course_code) {
+    return index_find(courses->root, course_key_from_code(course_code)) != NULL;
+}
+
+// Check validation for course code (any case)
+bool validate_course_code(const char *course_code) {
+    return course_key_from_code(course_code) != COURSE_KEY_INVALID;
 }
 
-// Deconstruct and free list
-void deconstruct(coursenode_t *courses) {
-    while (courses) {
-        coursenode_t *next = courses->next;
-        free(courses);
-        courses = next;
+// Check validation for letter grade
+bool validate_letter_grade(const char *letter_grade) {
+    return grade_from_string(letter_grade) != GRADE_INVALID;
+}
+
+// Deconstruct list, releasing the arena one slab at a time
+void deconstruct(courselist_t *courses) {
+    course_slab_t *slab = courses->slabs;
+
+    while (slab) {
+        course_slab_t *next = slab->next;
+        free(slab);
+        slab = next;
     }
+
+    free(courses->terms);
+    free(courses->subjects.slots);
+
+    courses->slabs = NULL;
+    courses->free_nodes = NULL;
+    courses->terms = NULL;
+    courses->subjects = (subject_index_t){0};
+    courses->root = NULL;
+    courses->head = NULL;
+    courses->count = 0;
+    courses->credits_earned = (cgpa_sum_t){0};
+    courses->credits_completed = (cgpa_sum_t){0};
+    // The grading scale is configuration, not contents, and is kept
 }
 
-// Flush input buffer
-void flush_stdin(void) {
-    int c_flush;
-    while ((c_flush = getchar()) != '\n' && c_flush != EOF);
-}
\ No newline at end of file
@@ -4,10 +4,15 @@
  * CGPA Calculator - public interface and shared definitions
  *
  * Defines:
- * - course data structures
+ * - course keys, letter grades and totals
+ * - the opaque transcript handle and its operations
  * - grading validation helpers
  * - input-related constants
  *
+ * Nothing here does I/O. Every transcript owns all of its state, so
+ * different transcripts can be used from different threads at once; a
+ * single transcript needs the caller's locking if it is shared.
+ *
  * Author: Arul Rao (Vidonicle)
  * License: MIT
  ***********************************/
@@ -16,66 +21,200 @@
 #define CGPA_H
 
 #include <stdbool.h>
-#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
 
 #define COURSE_CODE_BUF_LEN 10   // 8 chars + '\n' + '\0'
 #define COURSE_WEIGHT_BUF_LEN 6  // numeric input + '\n' + '\0'
 #define LETTER_GRADE_BUF_LEN 4   // 2 chars + '\n' + '\0'
 
-#define SEPERATOR1 "\n ===================================\n"  // Seperator for UI elements
-#define SEPERATOR2 " ===================================\n"    // Seperator for stacked elements
+#define COURSE_KEY_NUMBER_BITS 14  // 4 digits (0-9999)
+#define COURSE_KEY_LETTER_BITS 5   // A-Z as 0-25
+#define COURSE_KEY_BITS (4 * COURSE_KEY_LETTER_BITS + COURSE_KEY_NUMBER_BITS)
+#define COURSE_KEY_INVALID UINT64_MAX
+
+#define COURSE_KEY_SUBJECT(key) ((key) >> COURSE_KEY_NUMBER_BITS)
+#define COURSE_KEY_NUMBER(key) ((unsigned)((key) & ((1u << COURSE_KEY_NUMBER_BITS) - 1)))
+
+#define TERM_BUF_LEN 6  // Season letter + 4-digit year + '\0'
+#define TERM_FIRST_YEAR 1950
+#define TERM_LAST_YEAR 2149
+#define TERM_SEASONS 3  // Winter, Summer, Fall
+#define TERM_COUNT ((TERM_LAST_YEAR - TERM_FIRST_YEAR + 1) * TERM_SEASONS)
+#define TERM_NONE 0
+
+/*
+ * Course code packed as 4 x 5-bit letters followed by a 14-bit number.
+ * Integer order matches alphanumerical order of the code (34 bits used).
+ */
+typedef uint64_t course_key_t;
+
+/*
+ * Academic term, numbered in time order from 1 (Winter TERM_FIRST_YEAR)
+ * to TERM_COUNT; TERM_NONE for courses without one. Written W2025,
+ * S2025 (summer) or F2025.
+ */
+typedef uint16_t term_t;
+
+// Letter grades, best first
+typedef enum {
+    GRADE_A_PLUS = 0,
+    GRADE_A,
+    GRADE_A_MINUS,
+    GRADE_B_PLUS,
+    GRADE_B,
+    GRADE_B_MINUS,
+    GRADE_C_PLUS,
+    GRADE_C,
+    GRADE_C_MINUS,
+    GRADE_D_PLUS,
+    GRADE_D,
+    GRADE_D_MINUS,
+    GRADE_F,
+
+    GRADE_COUNT,
+    GRADE_INVALID = GRADE_COUNT
+} grade_t;
+
+// Grading scale tables, defined in scale.h
+typedef struct grading_scale grading_scale_t;
+
+// Aggregated transcript totals
+typedef struct {
+    double credits_earned;     // Sum of weight * grade points
+    double credits_completed;  // Sum of course weights
+    double cgpa;               // credits_earned / credits_completed (0 if empty)
+} cgpa_totals_t;
 
-typedef struct course {
-    char course_code[COURSE_CODE_BUF_LEN];
-    char letter_grade[LETTER_GRADE_BUF_LEN];
-    float course_weight;
-    float credits_earned;
-    struct course *next;
-} coursenode_t;
+course_key_t course_key_from_code(const char *course_code);
 
-typedef struct {
-    const char *grade;
-    float value;
-} grade_map_t;
+course_key_t course_key_from_chars(const char *course_code, size_t len);
 
-typedef enum {
-    MENU_INVALID = 0,  // Invalid option
+void course_key_to_code(course_key_t key, char *course_code);
 
-    MENU_ADD,
-    MENU_DELETE,
-    MENU_EDIT,
-    MENU_DISPLAY,
-    MENU_EXIT,
+/*
+ * Key range covered by a code prefix, such as "SYSC" (a subject), "SYSC2"
+ * (its 2000-level courses) or "SYSC2006", or by two prefixes joined by
+ * '-' ("SYSC2000-SYSC3999"). Letters may be in either case. Returns
+ * false if spec is none of these or the range runs backwards.
+ */
+bool course_key_range_from_string(const char *spec, course_key_t *first, course_key_t *last);
 
-    MENU_COUNT
-} menu_option_t;
+bool course_key_range_from_chars(const char *spec, size_t len, course_key_t *first,
+                                 course_key_t *last);
 
-void print_menu(void);
+uint64_t course_key_hash(course_key_t key);
 
-coursenode_t *fetch_node(coursenode_t *courses, const char *course_code);
+// TERM_NONE if the text is not a term
+term_t term_from_string(const char *term);
 
-bool add_course(coursenode_t **courses, const char *course_code, float course_weight,
-                const char *letter_grade);
+term_t term_from_chars(const char *term, size_t len);
 
-void delete_course(coursenode_t **courses, const char *course_code);
+// Write a term as text (needs TERM_BUF_LEN); "" for TERM_NONE
+void term_to_string(term_t term, char *buf);
 
-bool edit_course(coursenode_t **courses, const char *course_code_old, const char *course_code_new,
-                 float course_weight_new, const char *letter_grade_new);
+grade_t grade_from_string(const char *letter_grade);
 
-bool load_from_file(coursenode_t **courses, FILE *fptr);
+grade_t grade_from_chars(const char *letter_grade, size_t len);
 
-float earned_credits(float course_weight, const char *letter_grade);
+const char *grade_to_string(grade_t grade);
 
-void display_grades(coursenode_t *courses);
+float grade_points(grade_t grade);
 
-bool check_courses(coursenode_t *courses, const char *course_code);
+float earned_credits(float course_weight, const char *letter_grade);
 
-bool validate_course_code(char *course_code);
+bool validate_course_code(const char *course_code);
 
 bool validate_letter_grade(const char *letter_grade);
 
-void deconstruct(coursenode_t *course);
+// Transcript handle; the course list itself is private to the library
+typedef struct cgpa_transcript cgpa_transcript_t;
 
-void flush_stdin(void);
+typedef enum {
+    CGPA_OK = 0,
+    CGPA_ERR_CODE,       // Course code is not 4 letters + 4 digits
+    CGPA_ERR_WEIGHT,     // Weight not accepted by the transcript's scale
+    CGPA_ERR_GRADE,      // Letter grade not defined by the transcript's scale
+    CGPA_ERR_TERM,       // Term outside TERM_FIRST_YEAR..TERM_LAST_YEAR
+    CGPA_ERR_NOT_FOUND,  // No course with that code
+    CGPA_ERR_EXISTS,     // A course with that code is already in (server requests)
+    CGPA_ERR_OOM
+} cgpa_status_t;
+
+// One course, copied out of a transcript
+typedef struct {
+    char course_code[COURSE_CODE_BUF_LEN];  // Upper case, NUL-terminated
+    course_key_t key;
+    float course_weight;
+    float credits_earned;
+    grade_t grade;
+    term_t term;
+} cgpa_course_t;
+
+// Called for each course in code order; return false to stop early
+typedef bool (*cgpa_course_fn)(const cgpa_course_t *course, void *ctx);
+
+// Empty transcript graded on scale (NULL = built-in); NULL if out of memory
+cgpa_transcript_t *cgpa_transcript_create(const grading_scale_t *scale);
+
+void cgpa_transcript_destroy(cgpa_transcript_t *transcript);
+
+/*
+ * Add a course. Codes are case-insensitive. A code may be added more than
+ * once (retakes); lookups, updates and removals see the newest.
+ */
+cgpa_status_t cgpa_transcript_add(cgpa_transcript_t *transcript, const char *course_code,
+                                  float course_weight, const char *letter_grade);
+
+// Add a course taken in term (TERM_NONE for no term)
+cgpa_status_t cgpa_transcript_add_term(cgpa_transcript_t *transcript, const char *course_code,
+                                       float course_weight, const char *letter_grade,
+                                       term_t term);
+
+cgpa_status_t cgpa_transcript_remove(cgpa_transcript_t *transcript, const char *course_code);
+
+/*
+ * Change a course. NULL course_code_new or letter_grade_new, or a
+ * negative course_weight_new, keeps the current value.
+ */
+cgpa_status_t cgpa_transcript_update(cgpa_transcript_t *transcript, const char *course_code,
+                                     const char *course_code_new, float course_weight_new,
+                                     const char *letter_grade_new);
+
+cgpa_status_t cgpa_transcript_query(const cgpa_transcript_t *transcript, const char *course_code,
+                                    cgpa_course_t *course);
+
+size_t cgpa_transcript_count(const cgpa_transcript_t *transcript);
+
+// Totals from the running sums, in constant time
+cgpa_totals_t cgpa_transcript_totals(const cgpa_transcript_t *transcript);
+
+/*
+ * Totals of the courses taken in term, and of every course up to and
+ * including it, in O(log TERM_COUNT). Courses without a term are left
+ * out. count (may be NULL) receives the number of courses covered.
+ */
+cgpa_totals_t cgpa_transcript_term_totals(const cgpa_transcript_t *transcript, term_t term,
+                                          size_t *count);
+
+cgpa_totals_t cgpa_transcript_cumulative_totals(const cgpa_transcript_t *transcript, term_t term,
+                                                size_t *count);
+
+/*
+ * Totals of the courses with codes from first to last inclusive, such as
+ * one subject or course level (see course_key_range_from_string).
+ * Subjects the range covers whole are read from per-subject running
+ * totals in O(log n) each; courses of a subject it only partly covers
+ * are visited. count (may be NULL) receives the number of courses
+ * covered.
+ */
+cgpa_totals_t cgpa_transcript_range_totals(const cgpa_transcript_t *transcript, course_key_t first,
+                                           course_key_t last, size_t *count);
+
+/*
+ * Visit every course in code order. The transcript must not be changed
+ * from inside fn. Returns false if fn stopped the walk.
+ */
+bool cgpa_transcript_each(const cgpa_transcript_t *transcript, cgpa_course_fn fn, void *ctx);
 
 #endif /* CGPA_H */
\ No newline at end of file
@@ -0,0 +1,554 @@
+/***********************************
+ * cli.c
+ *
+ * CGPA Calculator - non-interactive command-line mode
+ *
+ * Handles:
+ * - argument parsing
+ * - load / save / report / batch / stream / what-if runs without the menu
+ * - starting the query daemon
+ * - exit codes for scripted use
+ *
+ * Author: Arul Rao (Vidonicle)
+ * License: MIT
+ ***********************************/
+#define _POSIX_C_SOURCE 200809L
+
+#include "cli.h"
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "batch.h"
+#include "cgpa.h"
+#include "courselist.h"
+#include "loader.h"
+#include "report.h"
+#include "scale.h"
+#include "server.h"
+#include "snapshot.h"
+#include "stream.h"
+#include "whatif.h"
+
+#define CLI_OUTPUT_BUF_LEN (1u << 16)  // stdout buffer for reports
+
+typedef struct {
+    const char *load_path;
+    const char *save_path;
+    const char *batch_path;
+    const char *stream_path;  // "-" = stdin
+    const char *serve_address;
+    const char *scales_path;
+    const char *scale_name;
+    const grading_scale_t *scale;
+    load_duplicates_t duplicates;
+    bool unique;
+    bool report;
+    bool term_report;
+    term_t term;  // TERM_NONE = every term
+    bool subject_report;
+    const char *subjects;  // Comma-separated code ranges; NULL = every subject
+    const char *plan;      // Planned weights for --target
+    double target;
+    report_format_t format;
+    size_t threads;  // 0 = one per core
+} cli_options_t;
+
+static void print_usage(FILE *out) {
+    fprintf(out,
+            "Usage: cgpa [options]\n"
+            "       cgpa            (no options: interactive menu)\n"
+            "       cgpa --journal FILE [--scales FILE] [--scale NAME] [--duplicates POLICY]\n"
+            "                       (interactive menu; edits are journaled to FILE and\n"
+            "                        restored on the next run)\n"
+            "\n"
+            "  --load FILE             load courses from FILE (.txt or " SNAPSHOT_EXT ")\n"
+            "  --save FILE             save the loaded courses as a binary snapshot\n"
+            "  --report                write the loaded courses and CGPA\n"
+            "  --term TERM|all         write the GPA of TERM (e.g. F2024) and the CGPA\n"
+            "                          through it, or of every term, for --load\n"
+            "  --subject RANGES|all    write the GPA of each comma-separated code range\n"
+            "                          (SYSC, SYSC2 or SYSC2000-SYSC3999), or of every\n"
+            "                          subject, for --load\n"
+            "  --target CGPA           write the lowest grades that reach CGPA over the\n"
+            "                          --plan courses, on top of any --load courses\n"
+            "  --plan WEIGHTS          planned course weights, e.g. 0.5,0.5,1.0\n"
+            "  --batch FILE            write per-student totals for a cohort FILE\n"
+            "  --stream FILE           write totals for FILE (- for stdin) in fixed memory\n"
+            "  --unique                with --stream, count only the first of each code\n"
+            "  --serve SOCKET|PORT     answer requests on a Unix socket or 127.0.0.1:PORT\n"
+            "                          until SIGINT/SIGTERM; --load seeds the courses and\n"
+            "                          --save writes them at shutdown\n"
+            "  --scales FILE           load grading scales from FILE\n"
+            "  --scale NAME            grade with scale NAME (default: " SCALE_DEFAULT_NAME ")\n"
+            "  --format text|csv|json  report format (default: text)\n"
+            "  --threads N             threads for --load and --target (default: one per\n"
+            "                          core)\n"
+            "  --duplicates POLICY     courses repeated in a --load file or already\n"
+            "                          loaded, or by one --batch student: reject (keep\n"
+            "                          the first and warn, the default), retakes (keep\n"
+            "                          all), first, last or best\n"
+            "  --help                  show this help\n");
+}
+
+// Report a usage problem and return the usage exit code
+static int usage_error(const char *msg, const char *arg) {
+    fprintf(stderr, "cgpa: %s%s%s\n", msg, arg ? ": " : "", arg ? arg : "");
+    print_usage(stderr);
+
+    return CLI_EXIT_USAGE;
+}
+
+static bool has_extension(const char *path, const char *ext) {
+    const char *dot = strrchr(path, '.');
+
+    return dot && strcmp(dot, ext) == 0;
+}
+
+static const char *snapshot_error(snapshot_status_t status) {
+    switch (status) {
+        case SNAPSHOT_ERR_IO:
+            return "could not read or write snapshot";
+        case SNAPSHOT_ERR_FORMAT:
+            return "not a valid course snapshot";
+        case SNAPSHOT_ERR_WEIGHT:
+            return "course weights must be multiples of 0.25 to save";
+        case SNAPSHOT_ERR_OOM:
+            return "out of memory";
+        case SNAPSHOT_OK:
+        default:
+            return "ok";
+    }
+}
+
+// Open an input file, reporting why it failed
+static FILE *open_input(const char *path) {
+    FILE *fptr = fopen(path, "r");
+
+    if (!fptr)
+        fprintf(stderr, "cgpa: %s: %s\n", path, strerror(errno));
+
+    return fptr;
+}
+
+// Load opts->load_path into courses
+static int load_courses(const cli_options_t *opts, courselist_t *courses) {
+    FILE *fptr = open_input(opts->load_path);
+    if (!fptr)
+        return CLI_EXIT_NOINPUT;
+
+    int status = CLI_EXIT_OK;
+    load_stats_t stats = {0};
+
+    if (has_extension(opts->load_path, SNAPSHOT_EXT)) {
+        snapshot_status_t loaded = snapshot_load(courses, fptr, opts->duplicates, &stats, NULL);
+
+        if (loaded != SNAPSHOT_OK) {
+            fprintf(stderr, "cgpa: %s: %s\n", opts->load_path, snapshot_error(loaded));
+            status = loaded == SNAPSHOT_ERR_FORMAT ? CLI_EXIT_DATAERR : CLI_EXIT_OSERR;
+        }
+    } else if (!load_from_file_parallel(courses, fptr, opts->threads, opts->duplicates, &stats)) {
+        fprintf(stderr, "cgpa: %s: could not load courses\n", opts->load_path);
+        status = CLI_EXIT_OSERR;
+    }
+
+    if (status == CLI_EXIT_OK && opts->duplicates == LOAD_DUP_REJECT && stats.duplicates > 0) {
+        fprintf(stderr, "cgpa: %s: %zu repeated courses dropped (see --duplicates)\n",
+                opts->load_path, stats.duplicates);
+    }
+    fclose(fptr);
+
+    return status;
+}
+
+static int save_courses(const cli_options_t *opts, const courselist_t *courses) {
+    snapshot_status_t saved = snapshot_save(courses, opts->save_path, 0);
+
+    if (saved == SNAPSHOT_OK)
+        return CLI_EXIT_OK;
+
+    fprintf(stderr, "cgpa: %s: %s\n", opts->save_path, snapshot_error(saved));
+    return saved == SNAPSHOT_ERR_WEIGHT ? CLI_EXIT_DATAERR : CLI_EXIT_CANTCREAT;
+}
+
+// Every comma-separated field of a --subject list is a code range
+static bool valid_ranges(const char *ranges) {
+    course_key_t first, last;
+
+    for (;;) {
+        size_t len = strcspn(ranges, ",");
+
+        if (!course_key_range_from_chars(ranges, len, &first, &last))
+            return false;
+        if (ranges[len] == '\0')
+            return true;
+
+        ranges += len + 1;
+    }
+}
+
+static const char *whatif_error(whatif_status_t status) {
+    switch (status) {
+        case WHATIF_ERR_TARGET:
+            return "target must be a CGPA of 0 or more";
+        case WHATIF_ERR_WEIGHT:
+            return "a planned weight is not accepted by the grading scale";
+        case WHATIF_ERR_PLAN:
+            return "too many planned courses";
+        case WHATIF_ERR_OOM:
+            return "out of memory";
+        case WHATIF_OK:
+        case WHATIF_UNREACHABLE:
+        default:
+            return "ok";
+    }
+}
+
+// Grades needed on the planned courses, on top of courses (may be empty)
+static int run_whatif(const cli_options_t *opts, const courselist_t *courses) {
+    float weights[WHATIF_MAX_PLANNED];
+    grade_t grades[WHATIF_MAX_PLANNED];
+    size_t count;
+
+    if (!whatif_plan_from_string(opts->plan, weights, &count) || count == 0) {
+        fprintf(stderr, "cgpa: --plan: expected 1 to %d weights, e.g. 0.5,0.5,1.0\n",
+                WHATIF_MAX_PLANNED);
+        return CLI_EXIT_USAGE;
+    }
+
+    cgpa_totals_t current = cgpa_current(courses);
+    whatif_result_t result;
+    whatif_status_t status = whatif_solve(&current, courses->scale, weights, count, opts->target,
+                                          opts->threads, grades, &result);
+
+    if (status != WHATIF_OK && status != WHATIF_UNREACHABLE) {
+        fprintf(stderr, "cgpa: --target: %s\n", whatif_error(status));
+        return status == WHATIF_ERR_OOM ? CLI_EXIT_OSERR : CLI_EXIT_DATAERR;
+    }
+
+    if (!report_whatif(courses->scale, weights, grades, count, opts->target, status, &result,
+                       opts->format))
+        return CLI_EXIT_IOERR;
+
+    return CLI_EXIT_OK;
+}
+
+static int run_load(const cli_options_t *opts) {
+    courselist_t courses = {0};
+
+    courses.scale = opts->scale;
+
+    int status = load_courses(opts, &courses);
+
+    if (status == CLI_EXIT_OK && opts->save_path)
+        status = save_courses(opts, &courses);
+
+    if (status == CLI_EXIT_OK && opts->report && !report_courses(&courses, opts->format))
+        status = CLI_EXIT_IOERR;
+
+    if (status == CLI_EXIT_OK && opts->term_report &&
+        !report_terms(&courses, opts->term, opts->format))
+        status = CLI_EXIT_IOERR;
+
+    if (status == CLI_EXIT_OK && opts->subject_report &&
+        !report_subjects(&courses, opts->subjects, opts->format))
+        status = CLI_EXIT_IOERR;
+
+    if (status == CLI_EXIT_OK && opts->plan)
+        status = run_whatif(opts, &courses);
+
+    deconstruct(&courses);
+    return status;
+}
+
+static int run_serve(const cli_options_t *opts) {
+    cgpa_transcript_t *transcript = cgpa_transcript_create(opts->scale);
+    if (!transcript) {
+        fprintf(stderr, "cgpa: out of memory\n");
+        return CLI_EXIT_OSERR;
+    }
+
+    int status = opts->load_path ? load_courses(opts, transcript) : CLI_EXIT_OK;
+
+    if (status == CLI_EXIT_OK) {
+        server_stats_t stats;
+
+        fprintf(stderr, "cgpa: serving %zu courses on %s\n", cgpa_transcript_count(transcript),
+                opts->serve_address);
+
+        switch (server_run(transcript, opts->serve_address, &stats)) {
+            case SERVER_OK:
+                fprintf(stderr, "cgpa: stopped after %zu requests from %zu connections\n",
+                        stats.requests, stats.connections);
+                break;
+            case SERVER_ERR_LISTEN:
+                fprintf(stderr, "cgpa: %s: could not listen: %s\n", opts->serve_address,
+                        strerror(errno));
+                status = CLI_EXIT_CANTCREAT;
+                break;
+            case SERVER_ERR_OOM:
+            case SERVER_ERR_IO:
+            default:
+                fprintf(stderr, "cgpa: server failed: %s\n", strerror(errno));
+                status = CLI_EXIT_OSERR;
+                break;
+        }
+    }
+
+    if (status == CLI_EXIT_OK && opts->save_path)
+        status = save_courses(opts, transcript);
+
+    cgpa_transcript_destroy(transcript);
+    return status;
+}
+
+static int run_batch(const cli_options_t *opts) {
+    FILE *fptr = open_input(opts->batch_path);
+    if (!fptr)
+        return CLI_EXIT_NOINPUT;
+
+    cohort_t cohort = {0};
+    cohort.scale = opts->scale;
+    cohort.duplicates = opts->duplicates;
+
+    load_stats_t stats;
+    bool loaded = cohort_load(&cohort, fptr, &stats);
+    fclose(fptr);
+
+    int status = CLI_EXIT_OK;
+
+    if (loaded && opts->duplicates == LOAD_DUP_REJECT && stats.duplicates > 0)
+        fprintf(stderr, "cgpa: %s: %zu repeated courses dropped (see --duplicates)\n",
+                opts->batch_path, stats.duplicates);
+
+    if (!loaded) {
+        fprintf(stderr, "cgpa: %s: could not load cohort\n", opts->batch_path);
+        status = CLI_EXIT_OSERR;
+    } else if (!report_cohort(&cohort, opts->format)) {
+        status = CLI_EXIT_IOERR;
+    }
+
+    cohort_free(&cohort);
+    return status;
+}
+
+// Parse the arguments as menu options
+bool cli_menu_options(int argc, char **argv, cli_menu_options_t *menu) {
+    *menu = (cli_menu_options_t){0};
+
+    for (int i = 1; i < argc; i += 2) {
+        if (i + 1 >= argc)
+            return false;
+
+        if (strcmp(argv[i], "--journal") == 0)
+            menu->journal_path = argv[i + 1];
+        else if (strcmp(argv[i], "--scales") == 0)
+            menu->scales_path = argv[i + 1];
+        else if (strcmp(argv[i], "--scale") == 0)
+            menu->scale_name = argv[i + 1];
+        else if (strcmp(argv[i], "--duplicates") != 0 ||
+                 !load_duplicates_from_string(argv[i + 1], &menu->duplicates))
+            return false;
+    }
+
+    return true;
+}
+
+// Load the scales file and pick a scale
+int cli_select_scale(const char *scales_path, const char *scale_name, scale_set_t *set,
+                     const grading_scale_t **scale) {
+    *scale = NULL;
+
+    if (scales_path) {
+        FILE *fptr = open_input(scales_path);
+        if (!fptr)
+            return CLI_EXIT_NOINPUT;
+
+        size_t line;
+        scale_status_t status = scale_set_load(set, fptr, &line);
+        fclose(fptr);
+
+        if (status == SCALE_ERR_OOM) {
+            fprintf(stderr, "cgpa: %s: out of memory\n", scales_path);
+            return CLI_EXIT_OSERR;
+        } else if (status != SCALE_OK) {
+            fprintf(stderr, "cgpa: %s:%zu: invalid grading scale\n", scales_path, line);
+            return CLI_EXIT_DATAERR;
+        }
+    }
+
+    if (scale_name && !(*scale = scale_set_find(set, scale_name))) {
+        fprintf(stderr, "cgpa: unknown grading scale: %s\n", scale_name);
+        return CLI_EXIT_USAGE;
+    }
+
+    return CLI_EXIT_OK;
+}
+
+static int run_stream(const cli_options_t *opts) {
+    bool from_stdin = strcmp(opts->stream_path, "-") == 0;
+    FILE *fptr = from_stdin ? stdin : open_input(opts->stream_path);
+    if (!fptr)
+        return CLI_EXIT_NOINPUT;
+
+    cgpa_totals_t totals;
+    stream_stats_t stats;
+    bool streamed = stream_totals(fileno(fptr), opts->scale, opts->unique, &totals, &stats);
+
+    if (!from_stdin)
+        fclose(fptr);
+
+    if (!streamed) {
+        fprintf(stderr, "cgpa: %s: could not read courses\n", opts->stream_path);
+        return CLI_EXIT_OSERR;
+    }
+
+    return report_totals(&totals, &stats, opts->format) ? CLI_EXIT_OK : CLI_EXIT_IOERR;
+}
+
+int cli_run(int argc, char **argv) {
+    cli_options_t opts = {0};
+    bool has_target = false;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        bool has_value = i + 1 < argc;
+
+        if (strcmp(arg, "--help") == 0 || strcmp(arg, "-h") == 0) {
+            print_usage(stdout);
+            return CLI_EXIT_OK;
+        } else if (strcmp(arg, "--report") == 0) {
+            opts.report = true;
+        } else if (strcmp(arg, "--term") == 0) {
+            if (!has_value)
+                return usage_error("missing term for", arg);
+            opts.term = term_from_string(argv[++i]);
+            if (opts.term == TERM_NONE && strcmp(argv[i], "all") != 0)
+                return usage_error("expected a term like F2024, or all, for", arg);
+            opts.term_report = true;
+        } else if (strcmp(arg, "--subject") == 0) {
+            if (!has_value)
+                return usage_error("missing code ranges for", arg);
+            opts.subjects = strcmp(argv[++i], "all") == 0 ? NULL : argv[i];
+            if (opts.subjects && !valid_ranges(opts.subjects))
+                return usage_error("expected code ranges like SYSC,SYSC2,SYSC2000-SYSC3999, "
+                                   "or all, for",
+                                   arg);
+            opts.subject_report = true;
+        } else if (strcmp(arg, "--target") == 0) {
+            char *endptr;
+            opts.target = has_value ? strtod(argv[i + 1], &endptr) : -1.0;
+
+            if (!has_value || *endptr != '\0' || endptr == argv[i + 1] || !(opts.target >= 0.0))
+                return usage_error("expected a CGPA for", arg);
+            has_target = true;
+            i++;
+        } else if (strcmp(arg, "--plan") == 0) {
+            if (!has_value)
+                return usage_error("missing weights for", arg);
+            opts.plan = argv[++i];
+        } else if (strcmp(arg, "--load") == 0) {
+            if (!has_value)
+                return usage_error("missing file for", arg);
+            opts.load_path = argv[++i];
+        } else if (strcmp(arg, "--save") == 0) {
+            if (!has_value)
+                return usage_error("missing file for", arg);
+            opts.save_path = argv[++i];
+        } else if (strcmp(arg, "--batch") == 0) {
+            if (!has_value)
+                return usage_error("missing file for", arg);
+            opts.batch_path = argv[++i];
+        } else if (strcmp(arg, "--stream") == 0) {
+            if (!has_value)
+                return usage_error("missing file for", arg);
+            opts.stream_path = argv[++i];
+        } else if (strcmp(arg, "--serve") == 0) {
+            if (!has_value)
+                return usage_error("missing socket or port for", arg);
+            opts.serve_address = argv[++i];
+        } else if (strcmp(arg, "--unique") == 0) {
+            opts.unique = true;
+        } else if (strcmp(arg, "--format") == 0) {
+            if (!has_value || !report_format_from_string(argv[i + 1], &opts.format))
+                return usage_error("expected text, csv or json for", arg);
+            i++;
+        } else if (strcmp(arg, "--threads") == 0) {
+            char *endptr;
+            long threads = has_value ? strtol(argv[i + 1], &endptr, 10) : -1;
+
+            if (threads < 0 || *endptr != '\0')
+                return usage_error("expected a thread count for", arg);
+            opts.threads = (size_t)threads;
+            i++;
+        } else if (strcmp(arg, "--duplicates") == 0) {
+            if (!has_value || !load_duplicates_from_string(argv[i + 1], &opts.duplicates))
+                return usage_error("expected reject, retakes, first, last or best for", arg);
+            i++;
+        } else if (strcmp(arg, "--scales") == 0) {
+            if (!has_value)
+                return usage_error("missing file for", arg);
+            opts.scales_path = argv[++i];
+        } else if (strcmp(arg, "--scale") == 0) {
+            if (!has_value)
+                return usage_error("missing name for", arg);
+            opts.scale_name = argv[++i];
+        } else if (strcmp(arg, "--journal") == 0) {
+            return usage_error("--journal only combines with --scales and --scale", NULL);
+        } else {
+            return usage_error("unknown option", arg);
+        }
+    }
+
+    if (has_target != (opts.plan != NULL))
+        return usage_error("--target and --plan go together", NULL);
+    if (!opts.load_path && !opts.batch_path && !opts.stream_path && !opts.serve_address &&
+        !opts.plan)
+        return usage_error("nothing to do (use --load, --batch, --stream, --serve or --target)",
+                           NULL);
+    if (opts.stream_path && (opts.load_path || opts.batch_path))
+        return usage_error("--stream cannot be combined with --load or --batch", NULL);
+    if (opts.unique && !opts.stream_path)
+        return usage_error("--unique needs --stream", NULL);
+    if (opts.serve_address && (opts.batch_path || opts.stream_path || opts.report))
+        return usage_error("--serve cannot be combined with --batch, --stream or --report", NULL);
+    if (opts.term_report && (!opts.load_path || opts.serve_address))
+        return usage_error("--term needs --load", NULL);
+    if (opts.subject_report && (!opts.load_path || opts.serve_address))
+        return usage_error("--subject needs --load", NULL);
+    if (opts.plan && (opts.serve_address || opts.stream_path || opts.batch_path))
+        return usage_error("--target cannot be combined with --serve, --stream or --batch", NULL);
+    if ((opts.report || opts.save_path) && !opts.load_path && !opts.serve_address)
+        return usage_error("--report and --save need --load", NULL);
+
+    scale_set_t scales = {0};
+    int status = cli_select_scale(opts.scales_path, opts.scale_name, &scales, &opts.scale);
+    if (status != CLI_EXIT_OK) {
+        scale_set_free(&scales);
+        return status;
+    }
+
+    setvbuf(stdout, NULL, _IOFBF, CLI_OUTPUT_BUF_LEN);
+
+    if (opts.stream_path)
+        status = run_stream(&opts);
+    if (opts.serve_address)
+        status = run_serve(&opts);
+    else if (opts.load_path)
+        status = run_load(&opts);
+    else if (opts.plan)
+        status = run_whatif(&opts, &(courselist_t){.scale = opts.scale});
+    if (status == CLI_EXIT_OK && opts.batch_path)
+        status = run_batch(&opts);
+
+    if (fflush(stdout) != 0 && status == CLI_EXIT_OK)
+        status = CLI_EXIT_IOERR;
+
+    scale_set_free(&scales);
+    return status;
+}
@@ -0,0 +1,68 @@
+/***********************************
+ * cli.h
+ *
+ * CGPA Calculator - non-interactive command-line mode
+ *
+ * Defines:
+ * - process exit codes
+ * - the command-line entry point
+ * - the options shared with the interactive menu
+ *
+ * Author: Arul Rao (Vidonicle)
+ * License: MIT
+ ***********************************/
+
+#ifndef CLI_H
+#define CLI_H
+
+#include <stdbool.h>
+
+#include "loader.h"
+#include "scale.h"
+
+// Exit codes follow sysexits.h so scripts can tell failures apart
+typedef enum {
+    CLI_EXIT_OK = 0,
+    CLI_EXIT_USAGE = 64,      // Bad or missing arguments
+    CLI_EXIT_DATAERR = 65,    // Input or data cannot be represented
+    CLI_EXIT_NOINPUT = 66,    // Input file missing or unreadable
+    CLI_EXIT_OSERR = 71,      // Out of memory or failed read
+    CLI_EXIT_CANTCREAT = 73,  // Output file could not be written
+    CLI_EXIT_IOERR = 74       // Output could not be written
+} cli_exit_t;
+
+/*
+ * Run without the menu, e.g.
+ *   cgpa --load courses.txt --report --format json
+ *   cgpa --load courses.txt --save courses.cgpa
+ *   cgpa --batch cohort.txt --format csv
+ *   cgpa --serve /tmp/cgpa.sock --load courses.txt
+ *
+ * Returns a cli_exit_t.
+ */
+int cli_run(int argc, char **argv);
+
+// Options that also apply to the interactive menu
+typedef struct {
+    const char *journal_path;      // --journal FILE
+    const char *scales_path;       // --scales FILE
+    const char *scale_name;        // --scale NAME
+    load_duplicates_t duplicates;  // --duplicates POLICY, for file loads
+} cli_menu_options_t;
+
+/*
+ * Parse the arguments as menu options. Returns false if any argument is
+ * not one, in which case the program should run cli_run instead.
+ */
+bool cli_menu_options(int argc, char **argv, cli_menu_options_t *menu);
+
+/*
+ * Load scales_path (may be NULL) into set and pick scale_name (NULL =
+ * built-in). Problems are reported on stderr.
+ *
+ * Returns a cli_exit_t.
+ */
+int cli_select_scale(const char *scales_path, const char *scale_name, scale_set_t *set,
+                     const grading_scale_t **scale);
+
+#endif /* CLI_H */
@@ -0,0 +1,171 @@
+/***********************************
+ * courselist.h
+ *
+ * CGPA Calculator - course list internals
+ *
+ * Defines:
+ * - the indexed course list behind cgpa_transcript_t
+ * - node, record and arena layouts
+ * - per-term Fenwick index
+ * - per-subject totals for code range queries
+ * - list operations used by the loaders, snapshots and CLI
+ *
+ * Not part of the library API: embedders use the handle in cgpa.h.
+ *
+ * Author: Arul Rao (Vidonicle)
+ * License: MIT
+ ***********************************/
+
+#ifndef COURSELIST_H
+#define COURSELIST_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cgpa.h"
+
+typedef struct course {
+    course_key_t key;
+    float course_weight;
+    float credits_earned;
+    int height;                   // AVL subtree height
+    uint8_t grade;                // grade_t
+    uint16_t term;                // term_t
+    struct course *left, *right;  // Index links, ordered by course code
+    struct course *prev, *next;   // In-order links for iteration
+} coursenode_t;
+
+// Compensated (Kahan-Babuska) running sum
+typedef struct {
+    double sum;
+    double comp;  // Low-order bits lost from sum
+} cgpa_sum_t;
+
+// Parsed course, before it becomes a list node
+typedef struct {
+    course_key_t key;
+    float course_weight;
+    uint8_t grade;  // grade_t
+    uint16_t term;  // term_t
+} course_record_t;
+
+// Block of nodes handed out by the course list's arena
+typedef struct course_slab {
+    struct course_slab *next;
+    size_t used;
+    size_t capacity;
+    coursenode_t nodes[];
+} course_slab_t;
+
+/*
+ * Fenwick trees over terms (1-based). Prefix sums give cumulative totals
+ * at a term, and a difference of two gives one term, in O(log T). Nodes
+ * are compensated like the list totals, so the two agree after any
+ * number of edits.
+ */
+typedef struct {
+    cgpa_sum_t credits_earned[TERM_COUNT + 1];
+    cgpa_sum_t credits_completed[TERM_COUNT + 1];
+    uint32_t courses[TERM_COUNT + 1];
+} term_index_t;
+
+// Running totals of one subject (the 4-letter prefix of a code)
+typedef struct {
+    uint32_t subject;  // COURSE_KEY_SUBJECT + 1; 0 = empty slot
+    uint32_t courses;
+    cgpa_sum_t credits_earned;
+    cgpa_sum_t credits_completed;
+} subject_totals_t;
+
+/*
+ * Open-addressed table of subject totals. A subject keeps its slot once
+ * added, so folding a course in or out never allocates.
+ */
+typedef struct {
+    subject_totals_t *slots;
+    size_t capacity;  // Power of two, or 0 before the first course
+    size_t used;
+} subject_index_t;
+
+/*
+ * A transcript handle is a course list. Everything it owns hangs off the
+ * struct, so separate lists never share mutable state.
+ */
+struct cgpa_transcript {
+    coursenode_t *root;  // Balanced index over course codes
+    coursenode_t *head;  // First course in code order
+    size_t count;
+
+    course_slab_t *slabs;      // Arena owning every node, newest first
+    coursenode_t *free_nodes;  // Recycled nodes, linked through next
+
+    cgpa_sum_t credits_earned;     // Running totals, kept by add/delete/edit
+    cgpa_sum_t credits_completed;
+
+    term_index_t *terms;  // Per-term totals, NULL until a course has a term
+
+    subject_index_t subjects;  // Per-subject totals
+
+    const grading_scale_t *scale;  // Set before adding courses; NULL = built-in scale
+};
+
+typedef struct cgpa_transcript courselist_t;
+
+coursenode_t *fetch_node(const courselist_t *courses, const char *course_code);
+
+coursenode_t *fetch_node_key(const courselist_t *courses, course_key_t key);
+
+// First course with a code of key or above, NULL if none
+coursenode_t *fetch_node_from(const courselist_t *courses, course_key_t key);
+
+bool add_course(courselist_t *courses, const char *course_code, float course_weight,
+                const char *letter_grade);
+
+bool add_course_key(courselist_t *courses, course_key_t key, float course_weight, grade_t grade);
+
+// Add a parsed course, term included
+bool add_course_record(courselist_t *courses, const course_record_t *record);
+
+void sort_course_records(course_record_t *records, course_record_t *scratch, size_t count);
+
+bool add_courses_sorted(courselist_t *courses, const course_record_t *records, size_t count);
+
+void delete_course(courselist_t *courses, const char *course_code);
+
+void delete_course_key(courselist_t *courses, course_key_t key);
+
+bool edit_course(courselist_t *courses, const char *course_code_old, const char *course_code_new,
+                 float course_weight_new, const char *letter_grade_new);
+
+bool edit_course_key(courselist_t *courses, course_key_t key_old, course_key_t key_new,
+                     float course_weight_new, grade_t grade_new);
+
+/*
+ * Bulk weight / grade update. Each record edits the first course with its
+ * key; a negative weight or GRADE_INVALID keeps the current value.
+ * edits is sorted in place. Returns the number of edits applied.
+ */
+size_t edit_courses(courselist_t *courses, course_record_t *edits, size_t count);
+
+cgpa_totals_t cgpa_current(const courselist_t *courses);
+
+// Totals for one term; count (may be NULL) receives its number of courses
+cgpa_totals_t cgpa_term(const courselist_t *courses, term_t term, size_t *count);
+
+// Totals for every term up to and including term
+cgpa_totals_t cgpa_through_term(const courselist_t *courses, term_t term, size_t *count);
+
+/*
+ * Totals for codes first..last inclusive. Subjects the range covers whole
+ * come from their running totals; only courses of the subjects at its
+ * ends are visited.
+ */
+cgpa_totals_t cgpa_range(const courselist_t *courses, course_key_t first, course_key_t last,
+                         size_t *count);
+
+bool check_courses(const courselist_t *courses, const char *course_code);
+
+void deconstruct(courselist_t *courses);
+
+#endif /* COURSELIST_H */
@@ -0,0 +1,192 @@
+/***********************************
+ * instrument.c
+ *
+ * CGPA Calculator - hot-path instrumentation
+ *
+ * Handles:
+ * - lock-free counters and latency histograms
+ * - the report dumped at exit or on SIGUSR1
+ *
+ * Author: Arul Rao (Vidonicle)
+ * License: MIT
+ ***********************************/
+#define _POSIX_C_SOURCE 200809L
+
+#include "instrument.h"
+
+#ifdef CGPA_INSTRUMENT
+
+#include <errno.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "writer.h"
+
+#define INSTR_DUMP_BUF_LEN 8192  // Stack buffer for one dump
+
+typedef struct {
+    atomic_uint_fast64_t calls;
+    atomic_uint_fast64_t total_ns;
+    atomic_uint_fast64_t max_ns;
+    atomic_uint_fast64_t buckets[INSTR_BUCKETS];  // Bucket b: latency < 2^b ns
+} instr_stats_t;
+
+static instr_stats_t instr_ops[INSTR_OP_COUNT];
+static atomic_uint_fast64_t instr_counters[INSTR_COUNTER_COUNT];
+
+static const char *const instr_op_names[INSTR_OP_COUNT] = {
+    "add_course", "add_bulk", "fetch_node", "edit_course", "edit_bulk", "delete_course",
+    "display", "load_file", "stream", "cohort_load", "snapshot_save", "snapshot_load", "request",
+    "whatif"};
+
+static const char *const instr_counter_names[INSTR_COUNTER_COUNT] = {"lines", "skipped", "bytes",
+                                                                      "records"};
+
+uint64_t instr_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+// Smallest b with ns < 2^b, capped at the last bucket
+static size_t instr_bucket(uint64_t ns) {
+    size_t b = 0;
+
+    while (b < INSTR_BUCKETS - 1 && (ns >> b) != 0)
+        b++;
+
+    return b;
+}
+
+void instr_record(instr_op_t op, uint64_t start_ns) {
+    uint64_t ns = instr_now() - start_ns;
+    instr_stats_t *stats = &instr_ops[op];
+
+    atomic_fetch_add_explicit(&stats->calls, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&stats->total_ns, ns, memory_order_relaxed);
+    atomic_fetch_add_explicit(&stats->buckets[instr_bucket(ns)], 1, memory_order_relaxed);
+
+    uint64_t max = atomic_load_explicit(&stats->max_ns, memory_order_relaxed);
+    while (ns > max && !atomic_compare_exchange_weak_explicit(&stats->max_ns, &max, ns,
+                                                              memory_order_relaxed,
+                                                              memory_order_relaxed))
+        ;
+}
+
+void instr_count(instr_counter_t counter, uint64_t n) {
+    atomic_fetch_add_explicit(&instr_counters[counter], n, memory_order_relaxed);
+}
+
+// Upper bound (ns) of the bucket holding the given fraction of calls
+static uint64_t instr_percentile(const uint64_t *buckets, uint64_t calls, double fraction) {
+    uint64_t target = (uint64_t)((double)calls * fraction + 0.5);
+    uint64_t seen = 0;
+
+    for (size_t b = 0; b < INSTR_BUCKETS; b++) {
+        seen += buckets[b];
+        if (seen >= target && seen > 0)
+            return (uint64_t)1 << b;
+    }
+
+    return (uint64_t)1 << (INSTR_BUCKETS - 1);
+}
+
+/*
+ * Only write(2) and the writer are used, both async-signal-safe, so this
+ * can run from the SIGUSR1 handler. Counters are read without a lock and
+ * may be a few calls apart.
+ */
+void instr_dump(int fd) {
+    char buf[INSTR_DUMP_BUF_LEN];
+    writer_t out;
+
+    writer_init(&out, fd, buf, sizeof buf);
+    writer_puts(&out, "\n=== cgpa instrumentation ===\n");
+
+    for (size_t i = 0; i < INSTR_COUNTER_COUNT; i++) {
+        writer_puts(&out, instr_counter_names[i]);
+        writer_puts(&out, ": ");
+        writer_uint(&out, atomic_load_explicit(&instr_counters[i], memory_order_relaxed), 0);
+        writer_putc(&out, '\n');
+    }
+
+    uint64_t load_ns = atomic_load_explicit(&instr_ops[INSTR_LOAD].total_ns, memory_order_relaxed);
+    if (load_ns > 0) {
+        uint64_t bytes = atomic_load_explicit(&instr_counters[INSTR_BYTES], memory_order_relaxed);
+        writer_puts(&out, "load MB/s: ");
+        writer_fixed(&out, (double)bytes * 1e3 / (double)load_ns, 1, 0);
+        writer_putc(&out, '\n');
+    }
+
+    writer_puts(&out, "op                  calls     total ms    mean ns"
+                      "     p50<=     p99<=    max ns\n");
+
+    for (size_t op = 0; op < INSTR_OP_COUNT; op++) {
+        const instr_stats_t *stats = &instr_ops[op];
+        uint64_t calls = atomic_load_explicit(&stats->calls, memory_order_relaxed);
+        if (calls == 0)
+            continue;
+
+        uint64_t buckets[INSTR_BUCKETS];
+        for (size_t b = 0; b < INSTR_BUCKETS; b++)
+            buckets[b] = atomic_load_explicit(&stats->buckets[b], memory_order_relaxed);
+
+        uint64_t total = atomic_load_explicit(&stats->total_ns, memory_order_relaxed);
+
+        writer_pad_right(&out, instr_op_names[op], 14);
+        writer_uint(&out, calls, 11);
+        writer_fixed(&out, (double)total / 1e6, 3, 13);
+        writer_uint(&out, total / calls, 11);
+        writer_uint(&out, instr_percentile(buckets, calls, 0.50), 10);
+        writer_uint(&out, instr_percentile(buckets, calls, 0.99), 10);
+        writer_uint(&out, atomic_load_explicit(&stats->max_ns, memory_order_relaxed), 10);
+        writer_putc(&out, '\n');
+
+        // Cumulative histogram: calls finishing under each power of two
+        writer_puts(&out, "  <ns:calls");
+        uint64_t seen = 0;
+        for (size_t b = 0; b < INSTR_BUCKETS; b++) {
+            if (buckets[b] == 0)
+                continue;
+            seen += buckets[b];
+            writer_putc(&out, ' ');
+            writer_uint(&out, (uint64_t)1 << b, 0);
+            writer_putc(&out, ':');
+            writer_uint(&out, seen, 0);
+        }
+        writer_putc(&out, '\n');
+    }
+
+    writer_flush(&out);
+}
+
+static void instr_on_signal(int sig) {
+    int saved_errno = errno;
+
+    (void)sig;
+    instr_dump(STDERR_FILENO);
+    errno = saved_errno;
+}
+
+static void instr_on_exit(void) {
+    instr_dump(STDERR_FILENO);
+}
+
+bool instr_install(void) {
+    struct sigaction sa = {0};
+
+    sa.sa_handler = instr_on_signal;
+    sigemptyset(&sa.sa_mask);
+    sa.sa_flags = SA_RESTART;
+
+    return sigaction(SIGUSR1, &sa, NULL) == 0 && atexit(instr_on_exit) == 0;
+}
+
+#endif /* CGPA_INSTRUMENT */
@@ -0,0 +1,80 @@
+/***********************************
+ * instrument.h
+ *
+ * CGPA Calculator - hot-path instrumentation
+ *
+ * Defines:
+ * - instrumented operations and counters
+ * - timing / counting macros that vanish unless CGPA_INSTRUMENT is set
+ *
+ * Author: Arul Rao (Vidonicle)
+ * License: MIT
+ ***********************************/
+
+#ifndef INSTRUMENT_H
+#define INSTRUMENT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef enum {
+    INSTR_ADD = 0,      // add_course
+    INSTR_ADD_BULK,     // add_courses_sorted
+    INSTR_FETCH,        // fetch_node / fetch_node_key
+    INSTR_EDIT,         // edit_course / edit_course_key
+    INSTR_EDIT_BULK,    // edit_courses
+    INSTR_DELETE,       // delete_course / delete_course_key
+    INSTR_DISPLAY,      // display_grades
+    INSTR_LOAD,         // load_from_file(_parallel)
+    INSTR_STREAM,       // stream_totals
+    INSTR_COHORT_LOAD,  // cohort_load
+    INSTR_SNAPSHOT_SAVE,
+    INSTR_SNAPSHOT_LOAD,
+    INSTR_REQUEST,      // One daemon request
+    INSTR_WHATIF,       // whatif_solve
+
+    INSTR_OP_COUNT
+} instr_op_t;
+
+typedef enum {
+    INSTR_LINES = 0,  // Lines scanned by file loads and streams
+    INSTR_SKIPPED,    // Lines without a valid course
+    INSTR_BYTES,      // Bytes scanned
+    INSTR_RECORDS,    // Courses parsed
+
+    INSTR_COUNTER_COUNT
+} instr_counter_t;
+
+#ifdef CGPA_INSTRUMENT
+
+#define INSTR_BUCKETS 40  // Latency histogram buckets, powers of two in ns
+
+// Monotonic time in nanoseconds
+uint64_t instr_now(void);
+
+// Add one timed call of op that started at start_ns
+void instr_record(instr_op_t op, uint64_t start_ns);
+
+void instr_count(instr_counter_t counter, uint64_t n);
+
+// Write every counter and histogram to fd; async-signal-safe
+void instr_dump(int fd);
+
+// Dump to stderr at exit and whenever SIGUSR1 arrives
+bool instr_install(void);
+
+#define INSTR_START(name) uint64_t name = instr_now()
+#define INSTR_END(op, name) instr_record((op), (name))
+#define INSTR_COUNT(counter, n) instr_count((counter), (uint64_t)(n))
+#define INSTR_INSTALL() instr_install()
+
+#else
+
+#define INSTR_START(name) ((void)0)
+#define INSTR_END(op, name) ((void)0)
+#define INSTR_COUNT(counter, n) ((void)0)
+#define INSTR_INSTALL() ((void)0)
+
+#endif /* CGPA_INSTRUMENT */
+
+#endif /* INSTRUMENT_H */
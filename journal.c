@@ -0,0 +1,364 @@
+/***********************************
+ * journal.c
+ *
+ * CGPA Calculator - write-ahead journal for menu edits
+ *
+ * Handles:
+ * - appending add / edit / delete entries with batched fsync
+ * - replaying the snapshot and journal on startup
+ * - compacting the journal into its snapshot
+ *
+ * Author: Arul Rao (Vidonicle)
+ * License: MIT
+ ***********************************/
+#define _POSIX_C_SOURCE 200809L
+
+#include "journal.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "cgpa.h"
+#include "courselist.h"
+#include "loader.h"
+#include "snapshot.h"
+#include "writer.h"
+
+#define ENTRY_CHECKED_LEN 32  // Bytes covered by the checksum
+
+// FNV-1a over the checked part of an entry
+static uint32_t entry_checksum(const unsigned char *entry) {
+    uint32_t hash = 0x811c9dc5u;
+
+    for (size_t i = 0; i < ENTRY_CHECKED_LEN; i++) {
+        hash ^= entry[i];
+        hash *= 0x01000193u;
+    }
+
+    return hash;
+}
+
+static journal_status_t snapshot_status(snapshot_status_t status) {
+    switch (status) {
+        case SNAPSHOT_OK:
+            return JOURNAL_OK;
+        case SNAPSHOT_ERR_FORMAT:
+            return JOURNAL_ERR_FORMAT;
+        case SNAPSHOT_ERR_WEIGHT:
+            return JOURNAL_ERR_WEIGHT;
+        case SNAPSHOT_ERR_OOM:
+            return JOURNAL_ERR_OOM;
+        case SNAPSHOT_ERR_IO:
+        default:
+            return JOURNAL_ERR_IO;
+    }
+}
+
+static bool write_bytes(int fd, const unsigned char *data, size_t len) {
+    char buf[JOURNAL_ENTRY_LEN];
+    writer_t out;
+
+    writer_init(&out, fd, buf, sizeof buf);
+    writer_write(&out, (const char *)data, len);
+
+    return writer_flush(&out);
+}
+
+static bool write_header(int fd) {
+    unsigned char header[JOURNAL_HEADER_LEN] = {0};
+
+    memcpy(header, JOURNAL_MAGIC, 8);
+    store_le(header + 8, JOURNAL_VERSION, 4);
+    store_le(header + 12, JOURNAL_ENTRY_LEN, 4);
+
+    return write_bytes(fd, header, sizeof header) && fsync(fd) == 0;
+}
+
+// Read the whole journal; entries are few since it is compacted regularly
+static journal_status_t read_journal(int fd, unsigned char **data, size_t *len) {
+    struct stat st;
+
+    if (fstat(fd, &st) != 0)
+        return JOURNAL_ERR_IO;
+
+    *len = (size_t)st.st_size;
+    *data = malloc(*len ? *len : 1);
+    if (!*data)
+        return JOURNAL_ERR_OOM;
+
+    size_t off = 0;
+    while (off < *len) {
+        ssize_t n = pread(fd, *data + off, *len - off, (off_t)off);
+
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return JOURNAL_ERR_IO;
+        off += (size_t)n;
+    }
+
+    return JOURNAL_OK;
+}
+
+static journal_status_t load_snapshot(journal_t *journal, courselist_t *courses,
+                                      uint64_t *snapshot_seq) {
+    FILE *fptr = fopen(journal->snapshot_path, "re");
+
+    *snapshot_seq = 0;
+    if (!fptr)
+        return errno == ENOENT ? JOURNAL_OK : JOURNAL_ERR_IO;
+
+    // The snapshot is the list as it was saved, retakes and all
+    snapshot_status_t status = snapshot_load(courses, fptr, LOAD_DUP_RETAKES, NULL, snapshot_seq);
+    fclose(fptr);
+
+    return snapshot_status(status);
+}
+
+static bool apply_entry(courselist_t *courses, const unsigned char *entry) {
+    grade_t grade = (grade_t)entry[1];
+    uint32_t weight_bits = (uint32_t)load_le(entry + 4, 4);
+    float course_weight;
+    course_key_t key = load_le(entry + 16, 8);
+
+    memcpy(&course_weight, &weight_bits, sizeof course_weight);
+
+    switch (entry[0]) {
+        case JOURNAL_OP_ADD: {
+            course_record_t record = {.key = key,
+                                      .course_weight = course_weight,
+                                      .grade = (uint8_t)grade,
+                                      .term = (term_t)load_le(entry + 2, 2)};
+            return add_course_record(courses, &record);
+        }
+        case JOURNAL_OP_DELETE:
+            delete_course_key(courses, key);
+            return true;
+        case JOURNAL_OP_EDIT:
+            return edit_course_key(courses, key, load_le(entry + 24, 8), course_weight, grade);
+        default:
+            return true;
+    }
+}
+
+/*
+ * Apply every intact entry after the snapshot. Returns the length of the
+ * intact prefix, or 0 if the list ran out of memory.
+ */
+static size_t replay_entries(journal_t *journal, courselist_t *courses,
+                             const unsigned char *data, size_t len, uint64_t snapshot_seq,
+                             size_t *replayed) {
+    size_t off = JOURNAL_HEADER_LEN;
+    uint64_t prev_seq = 0;
+
+    journal->seq = snapshot_seq;
+
+    for (; off + JOURNAL_ENTRY_LEN <= len; off += JOURNAL_ENTRY_LEN) {
+        const unsigned char *entry = data + off;
+        uint64_t seq = load_le(entry + 8, 8);
+
+        // A torn or stale entry ends the journal
+        if (load_le(entry + ENTRY_CHECKED_LEN, 4) != entry_checksum(entry) ||
+            entry[0] < JOURNAL_OP_ADD || entry[0] > JOURNAL_OP_EDIT ||
+            entry[1] >= GRADE_COUNT || load_le(entry + 2, 2) > TERM_COUNT || seq <= prev_seq)
+            break;
+
+        if (seq > snapshot_seq) {
+            if (!apply_entry(courses, entry))
+                return 0;
+            (*replayed)++;
+        }
+
+        if (seq > journal->seq)
+            journal->seq = seq;
+        prev_seq = seq;
+    }
+
+    journal->uncompacted = *replayed;
+    return off;
+}
+
+// Journal and snapshot names are built once, then the journal is replayed
+journal_status_t journal_open(journal_t *journal, const char *path, courselist_t *courses,
+                              size_t *replayed) {
+    size_t path_len = strlen(path);
+    size_t count = 0;
+
+    memset(journal, 0, sizeof *journal);
+    journal->fd = -1;
+
+    if (!replayed)
+        replayed = &count;
+    *replayed = 0;
+
+    journal->snapshot_path = malloc(path_len + sizeof SNAPSHOT_EXT);
+    if (!journal->snapshot_path)
+        return JOURNAL_ERR_OOM;
+
+    memcpy(journal->snapshot_path, path, path_len);
+    memcpy(journal->snapshot_path + path_len, SNAPSHOT_EXT, sizeof SNAPSHOT_EXT);
+
+    journal->fd = open(path, O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (journal->fd < 0) {
+        free(journal->snapshot_path);
+        journal->snapshot_path = NULL;
+        return JOURNAL_ERR_IO;
+    }
+
+    uint64_t snapshot_seq;
+    unsigned char *data = NULL;
+    size_t len = 0;
+    journal_status_t status = load_snapshot(journal, courses, &snapshot_seq);
+
+    if (status == JOURNAL_OK)
+        status = read_journal(journal->fd, &data, &len);
+
+    if (status == JOURNAL_OK && len < JOURNAL_HEADER_LEN) {
+        // New journal, or a crash before its header was written
+        if (ftruncate(journal->fd, 0) != 0 || !write_header(journal->fd) ||
+            !sync_parent_dir(path))
+            status = JOURNAL_ERR_IO;
+        journal->seq = snapshot_seq;
+    } else if (status == JOURNAL_OK) {
+        if (memcmp(data, JOURNAL_MAGIC, 8) != 0 ||
+            load_le(data + 8, 4) != JOURNAL_VERSION ||
+            load_le(data + 12, 4) != JOURNAL_ENTRY_LEN) {
+            status = JOURNAL_ERR_FORMAT;
+        } else {
+            size_t intact = replay_entries(journal, courses, data, len, snapshot_seq, replayed);
+
+            if (intact == 0)
+                status = JOURNAL_ERR_OOM;
+            else if (intact < len && (ftruncate(journal->fd, (off_t)intact) != 0 ||
+                                      fsync(journal->fd) != 0))
+                status = JOURNAL_ERR_IO;
+        }
+    }
+
+    free(data);
+
+    if (status != JOURNAL_OK) {
+        close(journal->fd);
+        free(journal->snapshot_path);
+        memset(journal, 0, sizeof *journal);
+        journal->fd = -1;
+        return status;
+    }
+
+    journal->last_sync = now_seconds();
+    return JOURNAL_OK;
+}
+
+static journal_status_t journal_sync(journal_t *journal) {
+    if (fsync(journal->fd) != 0)
+        return JOURNAL_ERR_IO;
+
+    journal->unsynced = 0;
+    journal->last_sync = now_seconds();
+    return JOURNAL_OK;
+}
+
+journal_status_t journal_flush(journal_t *journal) {
+    return journal->unsynced > 0 ? journal_sync(journal) : JOURNAL_OK;
+}
+
+static journal_status_t append_entry(journal_t *journal, const courselist_t *courses,
+                                     journal_op_t op, course_key_t key, course_key_t key_new,
+                                     float course_weight, grade_t grade, term_t term) {
+    /*
+     * Compact first: courses holds every earlier entry but not this one.
+     * A failed compaction is retried later; the journal alone stays valid.
+     */
+    if (journal->uncompacted >= JOURNAL_COMPACT_ENTRIES &&
+        journal_checkpoint(journal, courses) != JOURNAL_OK)
+        journal->uncompacted = 0;
+
+    unsigned char entry[JOURNAL_ENTRY_LEN] = {0};
+    uint32_t weight_bits;
+
+    memcpy(&weight_bits, &course_weight, sizeof weight_bits);
+
+    entry[0] = (unsigned char)op;
+    entry[1] = (unsigned char)grade;
+    store_le(entry + 2, term, 2);
+    store_le(entry + 4, weight_bits, 4);
+    store_le(entry + 8, journal->seq + 1, 8);
+    store_le(entry + 16, key, 8);
+    store_le(entry + 24, key_new, 8);
+    store_le(entry + ENTRY_CHECKED_LEN, entry_checksum(entry), 4);
+
+    if (!write_bytes(journal->fd, entry, sizeof entry))
+        return JOURNAL_ERR_IO;
+
+    journal->seq++;
+    journal->uncompacted++;
+
+    if (++journal->unsynced >= JOURNAL_SYNC_ENTRIES ||
+        now_seconds() - journal->last_sync >= JOURNAL_SYNC_SECONDS)
+        return journal_sync(journal);
+
+    return JOURNAL_OK;
+}
+
+journal_status_t journal_log_add(journal_t *journal, const courselist_t *courses,
+                                 course_key_t key, float course_weight, grade_t grade,
+                                 term_t term) {
+    return append_entry(journal, courses, JOURNAL_OP_ADD, key, key, course_weight, grade, term);
+}
+
+journal_status_t journal_log_delete(journal_t *journal, const courselist_t *courses,
+                                    course_key_t key) {
+    return append_entry(journal, courses, JOURNAL_OP_DELETE, key, key, 0.0f, GRADE_A_PLUS,
+                        TERM_NONE);
+}
+
+journal_status_t journal_log_edit(journal_t *journal, const courselist_t *courses,
+                                  course_key_t key_old, course_key_t key_new,
+                                  float course_weight, grade_t grade) {
+    return append_entry(journal, courses, JOURNAL_OP_EDIT, key_old, key_new, course_weight,
+                        grade, TERM_NONE);
+}
+
+/*
+ * Pending entries are synced first, so a failed save still leaves them
+ * durable. The snapshot is renamed into place before the journal is
+ * emptied. A crash in between leaves entries the snapshot already
+ * covers, which replay skips by sequence number.
+ */
+journal_status_t journal_checkpoint(journal_t *journal, const courselist_t *courses) {
+    journal_status_t status = journal_flush(journal);
+
+    if (status == JOURNAL_OK)
+        status = snapshot_status(snapshot_save(courses, journal->snapshot_path, journal->seq));
+    if (status != JOURNAL_OK)
+        return status;
+
+    if (ftruncate(journal->fd, JOURNAL_HEADER_LEN) != 0)
+        return JOURNAL_ERR_IO;
+
+    journal->uncompacted = 0;
+    return journal_sync(journal);
+}
+
+journal_status_t journal_close(journal_t *journal, const courselist_t *courses) {
+    journal_status_t status = journal_checkpoint(journal, courses);
+
+    if (status != JOURNAL_OK && journal_sync(journal) != JOURNAL_OK)
+        status = JOURNAL_ERR_IO;
+    if (close(journal->fd) != 0 && status == JOURNAL_OK)
+        status = JOURNAL_ERR_IO;
+
+    free(journal->snapshot_path);
+    memset(journal, 0, sizeof *journal);
+    journal->fd = -1;
+
+    return status;
+}
@@ -0,0 +1,104 @@
+/***********************************
+ * journal.h
+ *
+ * CGPA Calculator - write-ahead journal for menu edits
+ *
+ * Defines:
+ * - the append-only journal entry format
+ * - journal status codes and the journal handle
+ *
+ * Author: Arul Rao (Vidonicle)
+ * License: MIT
+ ***********************************/
+
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "courselist.h"
+
+#define JOURNAL_MAGIC "CGPAJRNL"
+#define JOURNAL_VERSION 1
+#define JOURNAL_SYNC_ENTRIES 16      // fsync after this many unsynced entries...
+#define JOURNAL_SYNC_SECONDS 1.0     // ...or once this long has passed
+#define JOURNAL_COMPACT_ENTRIES 4096  // Fold the journal into the snapshot after this many
+
+/*
+ * Layout (all integers little-endian):
+ *   header, 16 bytes: magic[8], version u32, entry size u32
+ *   entries, 40 bytes each:
+ *                     op u8, grade_t u8, term_t u16, weight f32 bits,
+ *                     sequence u64, course key u64, new course key u64,
+ *                     FNV-1a checksum of the first 32 bytes u32, reserved u32
+ *
+ * The term field was reserved (always zero) before terms existed, so old
+ * journals replay unchanged. Only adds carry a term; edits keep it.
+ *
+ * The journal belongs to a snapshot at <path>.cgpa. Entries whose sequence
+ * is not past the snapshot's are already folded into it and are skipped.
+ */
+#define JOURNAL_HEADER_LEN 16
+#define JOURNAL_ENTRY_LEN 40
+
+typedef enum {
+    JOURNAL_OP_ADD = 1,
+    JOURNAL_OP_DELETE,
+    JOURNAL_OP_EDIT
+} journal_op_t;
+
+typedef enum {
+    JOURNAL_OK = 0,
+    JOURNAL_ERR_IO,      // Could not read, write or sync the journal
+    JOURNAL_ERR_FORMAT,  // Journal or snapshot is not valid
+    JOURNAL_ERR_WEIGHT,  // A weight cannot be compacted into the snapshot
+    JOURNAL_ERR_OOM
+} journal_status_t;
+
+typedef struct {
+    int fd;
+    char *snapshot_path;
+    uint64_t seq;           // Sequence number of the last entry written
+    size_t unsynced;        // Entries written since the last fsync
+    size_t uncompacted;     // Entries written since the last snapshot
+    double last_sync;       // now_seconds() of the last fsync
+} journal_t;
+
+/*
+ * Open (or create) the journal at path and rebuild the course list from
+ * its snapshot plus every later entry. A torn entry at the end, left by a
+ * crash mid-write, is dropped. The snapshot is restored exactly as saved,
+ * repeated codes included (no duplicate policy). replayed may be NULL.
+ */
+journal_status_t journal_open(journal_t *journal, const char *path, courselist_t *courses,
+                              size_t *replayed);
+
+/*
+ * Log one menu edit before it is applied. Each entry reaches the kernel
+ * immediately; fsync is batched by JOURNAL_SYNC_ENTRIES / _SECONDS, which
+ * are only checked on the next append, so callers about to go idle call
+ * journal_flush. courses must already hold every earlier edit, as it is
+ * saved on compaction.
+ */
+journal_status_t journal_log_add(journal_t *journal, const courselist_t *courses,
+                                 course_key_t key, float course_weight, grade_t grade,
+                                 term_t term);
+
+journal_status_t journal_log_delete(journal_t *journal, const courselist_t *courses,
+                                    course_key_t key);
+
+journal_status_t journal_log_edit(journal_t *journal, const courselist_t *courses,
+                                  course_key_t key_old, course_key_t key_new,
+                                  float course_weight, grade_t grade);
+
+// fsync any entries logged since the last sync
+journal_status_t journal_flush(journal_t *journal);
+
+// Save courses as the snapshot and empty the journal
+journal_status_t journal_checkpoint(journal_t *journal, const courselist_t *courses);
+
+// Checkpoint and close; the handle is reset either way
+journal_status_t journal_close(journal_t *journal, const courselist_t *courses);
+
+#endif /* JOURNAL_H */
@@ -0,0 +1,595 @@
+/***********************************
+ * loader.c
+ *
+ * CGPA Calculator - transcript file loading
+ *
+ * Handles:
+ * - memory-mapping course files
+ * - in-place scanning of code / weight / grade / term tokens
+ * - sorting parsed records once and building the list in one pass
+ * - duplicate course policies
+ * - parallel parsing of large files into sorted runs
+ * - load throughput statistics
+ *
+ * Author: Arul Rao (Vidonicle)
+ * License: MIT
+ ***********************************/
+#define _POSIX_C_SOURCE 200809L
+
+#include "loader.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "cgpa.h"
+#include "courselist.h"
+#include "instrument.h"
+#include "scale.h"
+
+#define READ_CHUNK_LEN 65536  // Read size for streams that cannot be mapped
+#define WEIGHT_TOKEN_MAX 32   // Longest weight token, NUL included
+
+#define LOAD_MAX_THREADS 64              // Upper bound on parse workers
+#define LOAD_MIN_CHUNK_BYTES (1u << 20)  // Smaller inputs are not split
+#define RECORD_BYTES_ESTIMATE 16         // Typical line length, for sizing runs
+
+double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static bool is_blank(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+/*
+ * Parse a course weight token: a plain decimal, optionally signed, with no
+ * exponent. Values must round exactly as strtof does in the menu and the
+ * server. Short weights take the exact float fast path (a mantissa below
+ * 2^24 times or over a power of ten float holds exactly, rounded once);
+ * anything longer goes to strtof on a bounded copy.
+ */
+bool parse_weight(const char *tok, size_t len, float *weight) {
+    static const float pow10[] = {1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f,
+                                  1e6f, 1e7f, 1e8f, 1e9f, 1e10f};
+    const char *p = tok;
+    const char *end = tok + len;
+    bool negative = false;
+    uint32_t mantissa = 0;
+    size_t digits = 0, decimals = 0;
+
+    if (p < end && (*p == '+' || *p == '-'))
+        negative = (*p++ == '-');
+
+    for (; p < end && *p >= '0' && *p <= '9'; p++, digits++) {
+        if (mantissa <= (1u << 24))
+            mantissa = mantissa * 10 + (uint32_t)(*p - '0');
+    }
+
+    if (p < end && *p == '.') {
+        for (p++; p < end && *p >= '0' && *p <= '9'; p++, digits++, decimals++) {
+            if (mantissa <= (1u << 24))
+                mantissa = mantissa * 10 + (uint32_t)(*p - '0');
+        }
+    }
+
+    if (digits == 0 || p != end)
+        return false;
+
+    if (mantissa <= (1u << 24) && decimals < sizeof pow10 / sizeof pow10[0]) {
+        float value = (float)mantissa / pow10[decimals];
+        *weight = negative ? -value : value;
+        return true;
+    }
+
+    char buf[WEIGHT_TOKEN_MAX];
+    if (len >= sizeof buf)
+        return false;
+
+    memcpy(buf, tok, len);
+    buf[len] = '\0';
+    *weight = strtof(buf, NULL);
+
+    return true;
+}
+
+// Tokens starting like a number are meant as weights
+static bool is_numeric(char c) {
+    return (c >= '0' && c <= '9') || c == '+' || c == '-' || c == '.';
+}
+
+// Scan one line in [p, end) into record
+bool scan_course_line(const char *p, const char *end, const grading_scale_t *scale,
+                      course_record_t *record, load_stats_t *stats) {
+    stats->lines++;
+
+    while (p < end && is_blank(*p))
+        p++;
+
+    // Skip blank lines and comments, indented or not
+    if (p == end || *p == '#')
+        return false;
+
+    const char *tok = p;
+    while (p < end && !is_blank(*p))
+        p++;
+
+    course_key_t key = course_key_from_chars(tok, (size_t)(p - tok));
+    if (key == COURSE_KEY_INVALID) {
+        if (p != tok)
+            stats->skipped++;
+        return false;
+    }
+
+    // Default values
+    float course_weight = 1.0f;
+    grade_t grade = GRADE_F;
+    term_t term = TERM_NONE;
+
+    while (p < end) {
+        while (p < end && is_blank(*p))
+            p++;
+
+        tok = p;
+        while (p < end && !is_blank(*p))
+            p++;
+
+        size_t len = (size_t)(p - tok);
+        if (len == 0)
+            break;
+
+        // Get course weight; a number that is not one rejects the line
+        if (is_numeric(*tok)) {
+            if (!parse_weight(tok, len, &course_weight))
+                course_weight = -1.0f;
+            continue;
+        }
+
+        // Get letter grade
+        grade_t tok_grade = grade_from_chars(tok, len);
+        if (tok_grade != GRADE_INVALID) {
+            grade = tok_grade;
+            continue;
+        }
+
+        // Get term taken
+        term_t tok_term = term_from_chars(tok, len);
+        if (tok_term != TERM_NONE)
+            term = tok_term;
+    }
+
+    // Weights and grades must pass the same checks as in the menu and the handle API
+    if (!scale_accepts_weight(scale, course_weight) || !scale_accepts_grade(scale, grade)) {
+        stats->skipped++;
+        return false;
+    }
+
+    record->key = key;
+    record->course_weight = course_weight;
+    record->grade = (uint8_t)grade;
+    record->term = term;
+
+    return true;
+}
+
+// End of the line starting at p (the '\n' or end of buffer)
+const char *line_end(const char *p, const char *end) {
+    const char *eol = memchr(p, '\n', (size_t)(end - p));
+
+    return eol ? eol : end;
+}
+
+// Per-thread state for a parallel load
+typedef struct {
+    const char *start;
+    const char *end;
+    const grading_scale_t *scale;
+    course_record_t *records;  // Sorted run once the worker finishes
+    size_t count;
+    load_stats_t stats;
+    bool ok;
+} load_chunk_t;
+
+// Parse one chunk into a sorted run of records
+static void *parse_chunk(void *arg) {
+    load_chunk_t *chunk = arg;
+    size_t cap = (size_t)(chunk->end - chunk->start) / RECORD_BYTES_ESTIMATE + 16;
+
+    chunk->records = malloc(cap * sizeof(course_record_t));
+    if (!chunk->records)
+        return NULL;
+
+    for (const char *p = chunk->start; p < chunk->end;) {
+        const char *eol = line_end(p, chunk->end);
+
+        if (chunk->count == cap) {
+            course_record_t *grown = realloc(chunk->records, cap * 2 * sizeof(course_record_t));
+            if (!grown)
+                return NULL;
+            chunk->records = grown;
+            cap *= 2;
+        }
+
+        if (scan_course_line(p, eol, chunk->scale, &chunk->records[chunk->count],
+                             &chunk->stats))
+            chunk->count++;
+
+        p = eol < chunk->end ? eol + 1 : chunk->end;
+    }
+
+    course_record_t *scratch = malloc((chunk->count ? chunk->count : 1) * sizeof(course_record_t));
+    if (!scratch)
+        return NULL;
+
+    sort_course_records(chunk->records, scratch, chunk->count);
+    free(scratch);
+
+    chunk->stats.records = chunk->count;
+    chunk->stats.bytes = (size_t)(chunk->end - chunk->start);
+    chunk->ok = true;
+
+    return NULL;
+}
+
+// Run a's next record goes before run b's: lower code, then earlier run
+static bool run_before(const load_chunk_t *chunks, const size_t *pos, size_t a, size_t b) {
+    course_key_t key_a = chunks[a].records[pos[a]].key;
+    course_key_t key_b = chunks[b].records[pos[b]].key;
+
+    return key_a < key_b || (key_a == key_b && a < b);
+}
+
+// Restore the min-heap of runs below slot i
+static void heap_sift_down(size_t *heap, size_t n, size_t i, const load_chunk_t *chunks,
+                           const size_t *pos) {
+    for (;;) {
+        size_t least = i;
+        size_t left = 2 * i + 1;
+        size_t right = left + 1;
+
+        if (left < n && run_before(chunks, pos, heap[left], heap[least]))
+            least = left;
+        if (right < n && run_before(chunks, pos, heap[right], heap[least]))
+            least = right;
+        if (least == i)
+            return;
+
+        size_t tmp = heap[i];
+        heap[i] = heap[least];
+        heap[least] = tmp;
+        i = least;
+    }
+}
+
+/*
+ * Merge sorted runs into one array through a binary heap of runs, in
+ * O(n log runs). Runs are in file order, so taking the lowest run on
+ * ties keeps equal codes in file order.
+ */
+static course_record_t *merge_runs(const load_chunk_t *chunks, size_t n_chunks, size_t total) {
+    course_record_t *merged = malloc((total ? total : 1) * sizeof(course_record_t));
+    if (!merged)
+        return NULL;
+
+    size_t pos[LOAD_MAX_THREADS] = {0};
+    size_t heap[LOAD_MAX_THREADS];
+    size_t n = 0;
+
+    for (size_t c = 0; c < n_chunks; c++) {
+        if (chunks[c].count > 0)
+            heap[n++] = c;
+    }
+    for (size_t i = n / 2; i-- > 0;)
+        heap_sift_down(heap, n, i, chunks, pos);
+
+    for (size_t out = 0; n > 0; out++) {
+        size_t run = heap[0];
+
+        merged[out] = chunks[run].records[pos[run]++];
+        if (pos[run] == chunks[run].count)
+            heap[0] = heap[--n];
+        heap_sift_down(heap, n, 0, chunks, pos);
+    }
+
+    return merged;
+}
+
+bool load_duplicates_from_string(const char *name, load_duplicates_t *duplicates) {
+    if (strcmp(name, "reject") == 0)
+        *duplicates = LOAD_DUP_REJECT;
+    else if (strcmp(name, "retakes") == 0)
+        *duplicates = LOAD_DUP_RETAKES;
+    else if (strcmp(name, "first") == 0)
+        *duplicates = LOAD_DUP_FIRST;
+    else if (strcmp(name, "last") == 0)
+        *duplicates = LOAD_DUP_LAST;
+    else if (strcmp(name, "best") == 0)
+        *duplicates = LOAD_DUP_BEST;
+    else
+        return false;
+
+    return true;
+}
+
+/*
+ * Keep one record from each run of equal codes. The sort is stable, so
+ * every run is in file order. Returns the number of records kept.
+ */
+static size_t resolve_duplicates(const courselist_t *courses, course_record_t *records,
+                                 size_t count, load_duplicates_t duplicates) {
+    if (duplicates == LOAD_DUP_RETAKES)
+        return count;
+
+    const float *points = scale_points(courses->scale);
+    size_t kept = 0;
+
+    for (size_t i = 0; i < count;) {
+        size_t keep = i;
+        size_t j = i + 1;
+
+        for (; j < count && records[j].key == records[i].key; j++) {
+            if (duplicates == LOAD_DUP_LAST ||
+                (duplicates == LOAD_DUP_BEST &&
+                 points[records[j].grade] > points[records[keep].grade]))
+                keep = j;
+        }
+
+        records[kept++] = records[keep];
+        i = j;
+    }
+
+    return kept;
+}
+
+/*
+ * Apply the policy to records whose code is already in the list. The
+ * list holds the earlier attempts, so first and reject drop the record,
+ * while last and best (when it earns more) delete the listed courses to
+ * make way for it. Returns the number of records kept; *replaced counts
+ * the listed courses deleted.
+ */
+static size_t resolve_existing(courselist_t *courses, course_record_t *records, size_t count,
+                               load_duplicates_t duplicates, size_t *replaced) {
+    *replaced = 0;
+    if (duplicates == LOAD_DUP_RETAKES || courses->count == 0)
+        return count;
+
+    const float *points = scale_points(courses->scale);
+    size_t kept = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        coursenode_t *node = fetch_node_key(courses, records[i].key);
+        bool keep = !node;
+
+        if (node && duplicates == LOAD_DUP_LAST) {
+            keep = true;
+        } else if (node && duplicates == LOAD_DUP_BEST) {
+            keep = true;
+            for (; node && node->key == records[i].key; node = node->next) {
+                if (points[node->grade] >= points[records[i].grade])
+                    keep = false;
+            }
+        }
+
+        if (!keep)
+            continue;
+
+        for (; fetch_node_key(courses, records[i].key); (*replaced)++)
+            delete_course_key(courses, records[i].key);
+
+        records[kept++] = records[i];
+    }
+
+    return kept;
+}
+
+size_t load_resolve_records(courselist_t *courses, course_record_t *records, size_t count,
+                            load_duplicates_t duplicates, size_t *dropped) {
+    size_t replaced;
+    size_t kept = resolve_duplicates(courses, records, count, duplicates);
+
+    kept = resolve_existing(courses, records, kept, duplicates, &replaced);
+    *dropped = count - kept + replaced;
+
+    return kept;
+}
+
+/*
+ * Split a buffer at line boundaries and parse the pieces, on worker
+ * threads when there is more than one. The sorted runs are merged, the
+ * duplicate policy applied, and the list built in one pass.
+ */
+static bool parse_buffer(courselist_t *courses, const char *data, size_t len, size_t threads,
+                         load_duplicates_t duplicates, load_stats_t *stats) {
+    load_chunk_t chunks[LOAD_MAX_THREADS] = {{0}};
+    pthread_t workers[LOAD_MAX_THREADS];
+    bool started[LOAD_MAX_THREADS] = {false};
+    const char *end = data + len;
+    const char *p = data;
+
+    for (size_t i = 0; i < threads; i++) {
+        const char *split = end;
+
+        // Move each split point past the end of the line it lands in
+        if (i + 1 < threads) {
+            split = data + len / threads * (i + 1);
+            if (split < p)
+                split = p;
+
+            split = line_end(split, end);
+            if (split < end)
+                split++;
+        }
+
+        chunks[i].start = p;
+        chunks[i].end = split;
+        chunks[i].scale = courses->scale;
+        p = split;
+    }
+
+    for (size_t i = 0; threads > 1 && i < threads; i++)
+        started[i] = pthread_create(&workers[i], NULL, parse_chunk, &chunks[i]) == 0;
+
+    bool ok = true;
+    size_t total = 0;
+
+    for (size_t i = 0; i < threads; i++) {
+        if (started[i])
+            pthread_join(workers[i], NULL);
+        else
+            parse_chunk(&chunks[i]);  // Serial load, or fall back to this thread
+
+        ok = ok && chunks[i].ok;
+        total += chunks[i].count;
+
+        stats->bytes += chunks[i].stats.bytes;
+        stats->lines += chunks[i].stats.lines;
+        stats->skipped += chunks[i].stats.skipped;
+    }
+
+    // A single run is already the sorted whole
+    course_record_t *merged = NULL;
+    if (ok && threads == 1) {
+        merged = chunks[0].records;
+        chunks[0].records = NULL;
+    } else if (ok) {
+        merged = merge_runs(chunks, threads, total);
+    }
+
+    size_t dropped = 0;
+    size_t kept = merged ? load_resolve_records(courses, merged, total, duplicates, &dropped) : 0;
+
+    ok = merged && add_courses_sorted(courses, merged, kept);
+    if (ok) {
+        stats->records += kept;
+        stats->duplicates += dropped;
+    }
+
+    free(merged);
+    for (size_t i = 0; i < threads; i++)
+        free(chunks[i].records);
+
+    return ok;
+}
+
+// Parse a mapped or slurped buffer, in parallel when it is worth it
+static bool parse_data(courselist_t *courses, const char *data, size_t len, size_t threads,
+                       load_duplicates_t duplicates, load_stats_t *stats) {
+    if (threads == 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = online > 0 ? (size_t)online : 1;
+    }
+    if (threads > LOAD_MAX_THREADS)
+        threads = LOAD_MAX_THREADS;
+    if (threads > len / LOAD_MIN_CHUNK_BYTES)
+        threads = len / LOAD_MIN_CHUNK_BYTES;
+    if (threads == 0)
+        threads = 1;
+
+    return parse_buffer(courses, data, len, threads, duplicates, stats);
+}
+
+// Map a regular file, or read any other stream into memory
+bool file_view_open(file_view_t *view, FILE *fptr) {
+    *view = (file_view_t){0};
+
+    struct stat st;
+    int fd = fileno(fptr);
+
+    if (fd >= 0 && fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        size_t size = (size_t)st.st_size;
+        void *data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        if (data != MAP_FAILED) {
+            posix_madvise(data, size, POSIX_MADV_SEQUENTIAL);
+            view->data = data;
+            view->len = size;
+            view->mapped = true;
+            return true;
+        }
+    }
+
+    size_t cap = READ_CHUNK_LEN;
+    size_t len = 0;
+    char *buf = malloc(cap);
+    if (!buf)
+        return false;
+
+    size_t n;
+    while ((n = fread(buf + len, 1, cap - len, fptr)) > 0) {
+        len += n;
+
+        if (len == cap) {
+            char *grown = realloc(buf, cap * 2);
+            if (!grown) {
+                free(buf);
+                return false;
+            }
+            buf = grown;
+            cap *= 2;
+        }
+    }
+
+    if (ferror(fptr)) {
+        free(buf);
+        return false;
+    }
+
+    view->data = buf;
+    view->len = len;
+    return true;
+}
+
+void file_view_close(file_view_t *view) {
+    if (view->mapped)
+        munmap((void *)view->data, view->len);
+    else
+        free((void *)view->data);
+
+    *view = (file_view_t){0};
+}
+
+// Load courses on one thread
+bool load_from_file(courselist_t *courses, FILE *fptr, load_duplicates_t duplicates,
+                    load_stats_t *stats) {
+    return load_from_file_parallel(courses, fptr, 1, duplicates, stats);
+}
+
+// Load courses, splitting large files across threads (0 = one per core)
+bool load_from_file_parallel(courselist_t *courses, FILE *fptr, size_t threads,
+                             load_duplicates_t duplicates, load_stats_t *stats) {
+    load_stats_t local = {0};
+    if (!stats)
+        stats = &local;
+    *stats = (load_stats_t){0};
+
+    INSTR_START(instr_start);
+    double start = now_seconds();
+    file_view_t view;
+
+    if (!file_view_open(&view, fptr))
+        return false;
+
+    bool ok = parse_data(courses, view.data, view.len, threads, duplicates, stats);
+    file_view_close(&view);
+
+    stats->seconds = now_seconds() - start;
+    INSTR_END(INSTR_LOAD, instr_start);
+    INSTR_COUNT(INSTR_LINES, stats->lines);
+    INSTR_COUNT(INSTR_SKIPPED, stats->skipped);
+    INSTR_COUNT(INSTR_BYTES, stats->bytes);
+    INSTR_COUNT(INSTR_RECORDS, stats->records);
+
+    return ok;
+}
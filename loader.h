@@ -0,0 +1,120 @@
+/***********************************
+ * loader.h
+ *
+ * CGPA Calculator - transcript file loading
+ *
+ * Defines:
+ * - the course file loader
+ * - duplicate course policies
+ * - load statistics for throughput reporting
+ *
+ * Author: Arul Rao (Vidonicle)
+ * License: MIT
+ ***********************************/
+
+#ifndef LOADER_H
+#define LOADER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#include "courselist.h"
+
+/*
+ * Which courses sharing a code are kept, within a file and against the
+ * courses already in the list (which come before the file).
+ */
+typedef enum {
+    LOAD_DUP_REJECT = 0,  // Keep the first and drop the rest; callers warn
+    LOAD_DUP_RETAKES,     // Keep every attempt; all count toward the CGPA
+    LOAD_DUP_FIRST,       // Keep the first, silently
+    LOAD_DUP_LAST,        // Keep the last
+    LOAD_DUP_BEST         // Keep the most grade points (first on ties)
+} load_duplicates_t;
+
+typedef struct {
+    size_t bytes;       // Bytes scanned
+    size_t lines;       // Lines seen, including blanks and comments
+    size_t records;     // Courses added
+    size_t skipped;     // Lines without a valid course code, weight or grade
+    size_t duplicates;  // Courses dropped or replaced by the duplicate policy
+    double seconds;     // Wall time spent loading
+} load_stats_t;
+
+bool load_duplicates_from_string(const char *name, load_duplicates_t *duplicates);
+
+/*
+ * Apply the duplicate policy to sorted records (each run of a code in
+ * file order) about to go into courses with add_courses_sorted: within
+ * the records, then against the list, deleting listed courses that last
+ * or best replace. Kept records are packed to the front. *dropped counts
+ * the records dropped and listed courses replaced. Returns the number
+ * kept.
+ */
+size_t load_resolve_records(courselist_t *courses, course_record_t *records, size_t count,
+                            load_duplicates_t duplicates, size_t *dropped);
+
+// Whole file contents, mapped when possible
+typedef struct {
+    const char *data;
+    size_t len;
+    bool mapped;
+} file_view_t;
+
+/*
+ * Load courses from an open file.
+ * Regular files are memory-mapped and parsed in place; other streams
+ * are read into memory first. Records are sorted once, duplicates in the
+ * file and against courses already in the list are resolved by policy,
+ * and the list is built in one linear pass. stats may be NULL.
+ *
+ * Returns false on allocation or read failure.
+ */
+bool load_from_file(courselist_t *courses, FILE *fptr, load_duplicates_t duplicates,
+                    load_stats_t *stats);
+
+/*
+ * Same as load_from_file, but large inputs are split at line boundaries
+ * and parsed on up to threads workers (0 = one per online core). Each
+ * worker builds a sorted run; runs are merged before the policy applies.
+ * The resulting list matches a serial load of the same file.
+ */
+bool load_from_file_parallel(courselist_t *courses, FILE *fptr, size_t threads,
+                             load_duplicates_t duplicates, load_stats_t *stats);
+
+/*
+ * Scan one line in [p, end) into record.
+ * First token is the course code, then any order of weight / grade /
+ * term tokens (last one wins); anything else is ignored. A line whose
+ * weight scale (NULL = built-in) does not accept, including a numeric
+ * token that is not a plain decimal, is skipped. Updates the line and
+ * skipped counters in stats.
+ *
+ * Returns true if the line holds a course.
+ */
+bool scan_course_line(const char *p, const char *end, const grading_scale_t *scale,
+                      course_record_t *record, load_stats_t *stats);
+
+/*
+ * Parse a course weight token: a plain decimal, optionally signed, with no
+ * exponent. Rounds exactly as strtof does; tokens that need strtof must
+ * be under 32 characters.
+ */
+bool parse_weight(const char *tok, size_t len, float *weight);
+
+// End of the line starting at p (the '\n' or end)
+const char *line_end(const char *p, const char *end);
+
+/*
+ * Map a regular file read-only, or read any other stream into memory.
+ * Returns false on allocation or read failure.
+ */
+bool file_view_open(file_view_t *view, FILE *fptr);
+
+void file_view_close(file_view_t *view);
+
+// Monotonic clock in seconds
+double now_seconds(void);
+
+#endif /* LOADER_H */
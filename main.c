@@ -5,6 +5,8 @@
  *
  * Handles:
  * - menu loop
+ * - dispatch to command-line mode
+ * - journaling menu edits
  * - user input
  * - program flow control
  *
@@ -19,13 +21,71 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "batch.h"
 #include "cgpa.h"
+#include "cli.h"
+#include "courselist.h"
+#include "instrument.h"
+#include "journal.h"
+#include "loader.h"
+#include "scale.h"
+#include "snapshot.h"
+#include "ui.h"
 #include "ui_errors.h"
+#include "whatif.h"
 
 #define MENU_BUF_LEN 64            // 62 chars + '\n' + '\0'
 #define FILENAME_LEN MENU_BUF_LEN  // Length of filename
 
-int main() {
+// Stop journaling; the journal keeps everything logged so far
+static void stop_journal(journal_t *journal, const courselist_t *courses, bool *journaling) {
+    if (*journaling && journal_close(journal, courses) != JOURNAL_OK)
+        ui_print_error(UI_ERR_JOURNAL_WRITE);
+    *journaling = false;
+}
+
+// A failed journal write ends journaling but not the session
+static void check_journal(journal_status_t status, journal_t *journal, const courselist_t *courses,
+                          bool *journaling) {
+    if (status == JOURNAL_OK)
+        return;
+
+    ui_print_error(UI_ERR_JOURNAL_WRITE);
+    stop_journal(journal, courses, journaling);
+}
+
+// Validate a typed course code and rewrite it in upper case
+static bool normalize_course_code(char *course_code) {
+    if (!validate_course_code(course_code))
+        return false;
+
+    course_key_to_code(course_key_from_code(course_code), course_code);
+    return true;
+}
+
+// List the weights the scale accepts, e.g. "1.00, 0.50, 0.25"
+static void print_weight_choices(const grading_scale_t *scale) {
+    if (!scale)
+        scale = scale_default();
+
+    if (scale->weight_count == 0) {
+        printf("any weight above 0");
+        return;
+    }
+
+    for (size_t i = 0; i < scale->weight_count; i++)
+        printf(i ? ", %.2f" : "%.2f", scale->weights[i]);
+}
+
+int main(int argc, char **argv) {
+    cli_menu_options_t menu;
+
+    INSTR_INSTALL();
+
+    // Anything but menu options selects the non-interactive mode
+    if (!cli_menu_options(argc, argv, &menu))
+        return cli_run(argc, argv);
+
     char course_code_buf[COURSE_CODE_BUF_LEN];
     char course_weight_buf[COURSE_WEIGHT_BUF_LEN];
     float course_weight = 0.0f;
@@ -33,7 +93,34 @@ int main() {
     char filename[FILENAME_LEN];
     char menu_buf[MENU_BUF_LEN];
 
-    coursenode_t *courses = NULL;
+    courselist_t courses = {0};
+    scale_set_t scales = {0};
+    journal_t journal;
+    bool journaling = false;
+
+    int scale_status = cli_select_scale(menu.scales_path, menu.scale_name, &scales, &courses.scale);
+    if (scale_status != CLI_EXIT_OK) {
+        scale_set_free(&scales);
+        return scale_status;
+    }
+
+    if (menu.journal_path) {
+        size_t replayed;
+        journal_status_t status = journal_open(&journal, menu.journal_path, &courses, &replayed);
+
+        if (status != JOURNAL_OK) {
+            ui_print_error(status == JOURNAL_ERR_OOM ? UI_ERR_OOM : UI_ERR_JOURNAL_OPEN);
+            deconstruct(&courses);
+            scale_set_free(&scales);
+            return EXIT_FAILURE;
+        }
+
+        journaling = true;
+        printf(SEPERATOR1
+               "\n  Journal restored!\n"
+               "  -Courses: %zu (%zu edits replayed)\n",
+               courses.count, replayed);
+    }
 
     bool load_file = true;
 
@@ -48,7 +135,8 @@ int main() {
     if (load_file && menu_buf[0] != 'n') {
         // File parsing loop
         do {
-            printf(SEPERATOR1 "\n  Please enter the name of your file (.txt): ");
+            printf(SEPERATOR1 "\n  Please enter the name of your file (.txt or " SNAPSHOT_EXT
+                              "): ");
 
             fgets(filename, sizeof(filename), stdin);
             if (ui_handle_long_input(filename))
@@ -57,7 +145,7 @@ int main() {
 
             const char *ext = strrchr(filename, '.');
 
-            if (!ext || strcmp(ext, ".txt") != 0) {
+            if (!ext || (strcmp(ext, ".txt") != 0 && strcmp(ext, SNAPSHOT_EXT) != 0)) {
                 ui_print_error(UI_ERR_FILE_TYPE);
                 break;
             }
@@ -69,13 +157,52 @@ int main() {
                 break;
             }
 
-            if (!load_from_file(&courses, fptr)) {
+            // Binary snapshots load without parsing
+            if (strcmp(ext, SNAPSHOT_EXT) == 0) {
+                load_stats_t stats;
+                snapshot_status_t status =
+                    snapshot_load(&courses, fptr, menu.duplicates, &stats, NULL);
+                fclose(fptr);
+
+                if (status == SNAPSHOT_ERR_OOM) {
+                    ui_print_error(UI_ERR_OOM);
+                    deconstruct(&courses);
+                    scale_set_free(&scales);
+                    return EXIT_FAILURE;
+                } else if (status != SNAPSHOT_OK) {
+                    ui_print_error(UI_ERR_FILE_FORMAT);
+                } else {
+                    printf(SEPERATOR1
+                           "\n  Load from file successful!\n"
+                           "  -Courses loaded: %zu (%zu duplicates dropped)\n",
+                           stats.records, stats.duplicates);
+                    if (journaling)
+                        check_journal(journal_checkpoint(&journal, &courses), &journal, &courses,
+                                      &journaling);
+                }
+                break;
+            }
+
+            load_stats_t stats;
+
+            if (!load_from_file_parallel(&courses, fptr, 0, menu.duplicates, &stats)) {
                 ui_print_error(UI_ERR_OOM);
-                deconstruct(courses);
+                deconstruct(&courses);
+                scale_set_free(&scales);
                 return EXIT_FAILURE;
             } else {
-                printf(SEPERATOR1 "\n  Load from file successful!\n");
+                printf(SEPERATOR1
+                       "\n  Load from file successful!\n"
+                       "  -Courses loaded: %zu (%zu lines skipped, %zu duplicates dropped)\n"
+                       "  -Parse rate: %.1f MB/s\n",
+                       stats.records, stats.skipped, stats.duplicates,
+                       stats.seconds > 0 ? (double)stats.bytes / 1e6 / stats.seconds : 0.0);
                 fclose(fptr);
+
+                // Loaded courses are not in the journal, so fold them into its snapshot
+                if (journaling)
+                    check_journal(journal_checkpoint(&journal, &courses), &journal, &courses,
+                                  &journaling);
             }
 
         } while (0);
@@ -83,7 +210,11 @@ int main() {
 
     // Menu loop
     while (true) {
-        print_menu();
+        // Nothing is logged while the menu waits, so make every edit so far durable
+        if (journaling)
+            check_journal(journal_flush(&journal), &journal, &courses, &journaling);
+
+        print_menu(courses.scale);
 
         if (!fgets(menu_buf, sizeof(menu_buf), stdin))
             break;  // Get choice (1-MENU_COUNT)
@@ -116,18 +247,20 @@ int main() {
                         break;
                     course_code_buf[strcspn(course_code_buf, "\n")] = '\0';
 
-                    if (!validate_course_code(course_code_buf)) {
+                    if (!normalize_course_code(course_code_buf)) {
                         ui_print_error(UI_ERR_INVALID_CODE);
                         break;
                     }
 
-                    if (check_courses(courses, course_code_buf)) {
+                    if (check_courses(&courses, course_code_buf)) {
                         ui_print_error(UI_ERR_DUPLICATE);
                         break;
                     }
 
                     // Course Weight
-                    printf(SEPERATOR2 "  Please enter your course weight (1.00, 0.50, 0.25): ");
+                    printf(SEPERATOR2 "  Please enter your course weight (");
+                    print_weight_choices(courses.scale);
+                    printf("): ");
 
                     if (!fgets(course_weight_buf, sizeof course_weight_buf, stdin))
                         break;
@@ -138,8 +271,7 @@ int main() {
                     char *cw_endptr;
                     course_weight = strtof(course_weight_buf, &cw_endptr);
 
-                    if (*cw_endptr != '\0' || !(course_weight == 1.0f || course_weight == 0.5f ||
-                                                course_weight == 0.25f)) {
+                    if (*cw_endptr != '\0' || !scale_accepts_weight(courses.scale, course_weight)) {
                         ui_print_error(UI_ERR_INVALID_WEIGHT);
                         break;
                     }
@@ -156,14 +288,24 @@ int main() {
                     letter_grade_buf[strcspn(letter_grade_buf, "\n")] = '\0';
                     letter_grade_buf[0] = (char)toupper((unsigned char)letter_grade_buf[0]);
 
-                    if (!validate_letter_grade(letter_grade_buf)) {
+                    if (!validate_letter_grade(letter_grade_buf) ||
+                        !scale_accepts_grade(courses.scale, grade_from_string(letter_grade_buf))) {
                         ui_print_error(UI_ERR_INVALID_GRADE);
                         break;
                     }
 
+                    if (journaling)
+                        check_journal(journal_log_add(&journal, &courses,
+                                                      course_key_from_code(course_code_buf),
+                                                      course_weight,
+                                                      grade_from_string(letter_grade_buf),
+                                                      TERM_NONE),
+                                      &journal, &courses, &journaling);
+
                     if (!add_course(&courses, course_code_buf, course_weight, letter_grade_buf)) {
                         ui_print_error(UI_ERR_OOM);
-                        deconstruct(courses);
+                        deconstruct(&courses);
+                        scale_set_free(&scales);
                         return EXIT_FAILURE;
                     } else {
                         printf(SEPERATOR2
@@ -176,7 +318,7 @@ int main() {
                 } while (0);
                 break;
             case (MENU_DELETE):
-                if (!courses) {
+                if (courses.count == 0) {
                     ui_print_error(UI_ERR_EMPTY);
                     continue;
                 }
@@ -191,12 +333,17 @@ int main() {
                     break;
                 course_code_buf[strcspn(course_code_buf, "\n")] = '\0';
 
-                if (!validate_course_code(course_code_buf)) {
+                if (!normalize_course_code(course_code_buf)) {
                     ui_print_error(UI_ERR_INVALID_CODE);
                 } else {
-                    if (!check_courses(courses, course_code_buf)) {
+                    if (!check_courses(&courses, course_code_buf)) {
                         ui_print_error(UI_ERR_NOT_FOUND);
                     } else {
+                        if (journaling)
+                            check_journal(journal_log_delete(&journal, &courses,
+                                                             course_key_from_code(course_code_buf)),
+                                          &journal, &courses, &journaling);
+
                         delete_course(&courses, course_code_buf);
                         printf(SEPERATOR2 "\n  Course successfully deleted\n");
                     }
@@ -215,12 +362,12 @@ int main() {
                         break;
                     course_code_buf[strcspn(course_code_buf, "\n")] = '\0';
 
-                    if (!validate_course_code(course_code_buf)) {
+                    if (!normalize_course_code(course_code_buf)) {
                         ui_print_error(UI_ERR_INVALID_CODE);
                         break;
                     }
 
-                    if (!check_courses(courses, course_code_buf)) {
+                    if (!check_courses(&courses, course_code_buf)) {
                         ui_print_error(UI_ERR_NOT_FOUND);
                         break;
                     }
@@ -228,10 +375,10 @@ int main() {
                     char course_code_old[COURSE_CODE_BUF_LEN];
                     strcpy(course_code_old, course_code_buf);
 
-                    coursenode_t *fetched_node = fetch_node(courses, course_code_buf);
+                    coursenode_t *fetched_node = fetch_node(&courses, course_code_buf);
                     float old_weight = fetched_node->course_weight;
                     char old_grade[LETTER_GRADE_BUF_LEN];
-                    strcpy(old_grade, fetched_node->letter_grade);
+                    strcpy(old_grade, grade_to_string((grade_t)fetched_node->grade));
 
                     // Get new course code
                     printf(SEPERATOR2 "  Enter new course code (leave blank for no changes): ");
@@ -246,7 +393,7 @@ int main() {
                     if (course_code_buf[0] == '\0') {
                         strcpy(course_code_new, course_code_old);
                     } else {
-                        if (!validate_course_code(course_code_buf)) {
+                        if (!normalize_course_code(course_code_buf)) {
                             ui_print_error(UI_ERR_INVALID_CODE);
                             break;
                         }
@@ -254,7 +401,7 @@ int main() {
                     }
 
                     if (strcmp(course_code_new, course_code_old) != 0 &&
-                        check_courses(courses, course_code_new)) {
+                        check_courses(&courses, course_code_new)) {
                         ui_print_error(UI_ERR_DUPLICATE);
                         break;
                     }
@@ -274,7 +421,7 @@ int main() {
                         char *cwn_endptr;
                         float tmp = strtof(course_weight_buf, &cwn_endptr);
 
-                        if (*cwn_endptr != '\0' || !(tmp == 1.0f || tmp == 0.5f || tmp == 0.25f)) {
+                        if (*cwn_endptr != '\0' || !scale_accepts_weight(courses.scale, tmp)) {
                             ui_print_error(UI_ERR_INVALID_WEIGHT);
                             break;
                         }
@@ -296,7 +443,9 @@ int main() {
                     } else {
                         letter_grade_buf[0] = (char)toupper((unsigned char)letter_grade_buf[0]);
 
-                        if (!validate_letter_grade(letter_grade_buf)) {
+                        if (!validate_letter_grade(letter_grade_buf) ||
+                            !scale_accepts_grade(courses.scale,
+                                                 grade_from_string(letter_grade_buf))) {
                             ui_print_error(UI_ERR_INVALID_GRADE);
                             break;
                         }
@@ -304,10 +453,19 @@ int main() {
                     }
 
                     // Finalize edit
+                    if (journaling)
+                        check_journal(journal_log_edit(&journal, &courses,
+                                                       course_key_from_code(course_code_old),
+                                                       course_key_from_code(course_code_new),
+                                                       course_weight_new,
+                                                       grade_from_string(letter_grade_new)),
+                                      &journal, &courses, &journaling);
+
                     if (!edit_course(&courses, course_code_old, course_code_new, course_weight_new,
                                      letter_grade_new)) {
                         ui_print_error(UI_ERR_OOM);
-                        deconstruct(courses);
+                        deconstruct(&courses);
+                        scale_set_free(&scales);
                         return EXIT_FAILURE;
                     }
                     printf(SEPERATOR2
@@ -320,13 +478,152 @@ int main() {
                 } while (0);
                 break;
             case (MENU_DISPLAY):
-                display_grades(courses);
+                display_grades(&courses);
+                break;
+            case (MENU_WHATIF):
+                do {
+                    printf(SEPERATOR1 "\n  Please enter your target CGPA (0 to %.2f): ",
+                           scale_max_points(courses.scale));
+
+                    if (!fgets(menu_buf, sizeof(menu_buf), stdin))
+                        break;
+                    if (ui_handle_long_input(menu_buf))
+                        break;
+                    menu_buf[strcspn(menu_buf, "\n")] = '\0';
+
+                    char *target_endptr;
+                    double target = strtod(menu_buf, &target_endptr);
+
+                    if (*target_endptr != '\0' || target_endptr == menu_buf || !(target >= 0.0)) {
+                        ui_print_error(UI_ERR_INVALID_TARGET);
+                        break;
+                    }
+
+                    printf(SEPERATOR2 "  Please enter the weights of your planned courses "
+                                      "(Ex. 0.5 0.5 1.0): ");
+
+                    if (!fgets(menu_buf, sizeof(menu_buf), stdin))
+                        break;
+                    if (ui_handle_long_input(menu_buf))
+                        break;
+                    menu_buf[strcspn(menu_buf, "\n")] = '\0';
+
+                    float weights[WHATIF_MAX_PLANNED];
+                    grade_t grades[WHATIF_MAX_PLANNED];
+                    size_t count;
+
+                    if (!whatif_plan_from_string(menu_buf, weights, &count) || count == 0) {
+                        ui_print_error(UI_ERR_INVALID_WEIGHT);
+                        break;
+                    }
+
+                    cgpa_totals_t current = cgpa_current(&courses);
+                    whatif_result_t result;
+                    whatif_status_t status = whatif_solve(&current, courses.scale, weights, count,
+                                                          target, 0, grades, &result);
+
+                    if (status == WHATIF_ERR_WEIGHT) {
+                        ui_print_error(UI_ERR_INVALID_WEIGHT);
+                        break;
+                    }
+                    if (status == WHATIF_ERR_OOM) {
+                        ui_print_error(UI_ERR_OOM);
+                        deconstruct(&courses);
+                        scale_set_free(&scales);
+                        return EXIT_FAILURE;
+                    }
+                    if (status != WHATIF_OK && status != WHATIF_UNREACHABLE) {
+                        ui_print_error(UI_ERR_INVALID_TARGET);
+                        break;
+                    }
+
+                    display_whatif(courses.scale, weights, grades, count, target, status, &result);
+                } while (0);
+                break;
+            case (MENU_BATCH):
+                do {
+                    printf(SEPERATOR1 "\n  Please enter the name of your cohort file (.txt): ");
+
+                    if (!fgets(filename, sizeof(filename), stdin))
+                        break;
+                    if (ui_handle_long_input(filename))
+                        break;
+                    filename[strcspn(filename, "\n")] = '\0';
+
+                    const char *ext = strrchr(filename, '.');
+
+                    if (!ext || strcmp(ext, ".txt") != 0) {
+                        ui_print_error(UI_ERR_FILE_TYPE);
+                        break;
+                    }
+
+                    FILE *fptr = fopen(filename, "r");
+
+                    if (!fptr) {
+                        ui_print_error(UI_ERR_FILE_NOT_FOUND);
+                        break;
+                    }
+
+                    cohort_t cohort = {0};
+                    cohort.scale = courses.scale;
+                    cohort.duplicates = menu.duplicates;
+                    bool loaded = cohort_load(&cohort, fptr, NULL);
+                    fclose(fptr);
+
+                    if (!loaded) {
+                        ui_print_error(UI_ERR_OOM);
+                        cohort_free(&cohort);
+                        deconstruct(&courses);
+                        scale_set_free(&scales);
+                        return EXIT_FAILURE;
+                    }
+
+                    display_cohort(&cohort);
+                    cohort_free(&cohort);
+                } while (0);
+                break;
+            case (MENU_SAVE):
+                do {
+                    printf(SEPERATOR1 "\n  Please enter the name of the file to save to"
+                                      " (" SNAPSHOT_EXT "): ");
+
+                    if (!fgets(filename, sizeof(filename), stdin))
+                        break;
+                    if (ui_handle_long_input(filename))
+                        break;
+                    filename[strcspn(filename, "\n")] = '\0';
+
+                    const char *ext = strrchr(filename, '.');
+
+                    if (!ext || strcmp(ext, SNAPSHOT_EXT) != 0) {
+                        ui_print_error(UI_ERR_FILE_TYPE);
+                        break;
+                    }
+
+                    snapshot_status_t status = snapshot_save(&courses, filename, 0);
+
+                    if (status == SNAPSHOT_ERR_WEIGHT) {
+                        ui_print_error(UI_ERR_SAVE_WEIGHT);
+                    } else if (status != SNAPSHOT_OK) {
+                        ui_print_error(UI_ERR_FILE_WRITE);
+                    } else {
+                        printf(SEPERATOR2 "\n  Courses saved to %s\n", filename);
+                    }
+                } while (0);
                 break;
             case (MENU_EXIT):
                 printf("\n  Goodbye!\n");
-                deconstruct(courses);
+                stop_journal(&journal, &courses, &journaling);
+                deconstruct(&courses);
+                scale_set_free(&scales);
                 return EXIT_SUCCESS;
                 break;
         }
     }
+
+    // End of input
+    stop_journal(&journal, &courses, &journaling);
+    deconstruct(&courses);
+    scale_set_free(&scales);
+    return EXIT_SUCCESS;
 }
\ No newline at end of file
@@ -0,0 +1,533 @@
+/***********************************
+ * report.c
+ *
+ * CGPA Calculator - machine-readable reports
+ *
+ * Handles:
+ * - CSV and JSON output of course lists and cohorts
+ * - per-term and cumulative GPA tables
+ * - per-subject and code range GPA tables
+ * - what-if grade plans
+ * - streamed totals in every format
+ * - field quoting and string escaping
+ *
+ * Author: Arul Rao (Vidonicle)
+ * License: MIT
+ ***********************************/
+#define _POSIX_C_SOURCE 200809L
+
+#include "report.h"
+
+#include <ctype.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "batch.h"
+#include "cgpa.h"
+#include "courselist.h"
+#include "scale.h"
+#include "stream.h"
+#include "ui.h"
+#include "whatif.h"
+#include "writer.h"
+
+bool report_format_from_string(const char *name, report_format_t *format) {
+    if (strcmp(name, "text") == 0)
+        *format = REPORT_TEXT;
+    else if (strcmp(name, "csv") == 0)
+        *format = REPORT_CSV;
+    else if (strcmp(name, "json") == 0)
+        *format = REPORT_JSON;
+    else
+        return false;
+
+    return true;
+}
+
+// Quote a CSV field only when it needs it
+static void csv_field(writer_t *out, const char *field) {
+    if (!strpbrk(field, ",\"\r\n")) {
+        writer_puts(out, field);
+        return;
+    }
+
+    writer_putc(out, '"');
+    for (const char *c = field; *c; c++) {
+        if (*c == '"')
+            writer_putc(out, '"');
+        writer_putc(out, *c);
+    }
+    writer_putc(out, '"');
+}
+
+static void json_string(writer_t *out, const char *str) {
+    static const char hex[] = "0123456789abcdef";
+
+    writer_putc(out, '"');
+
+    for (const unsigned char *c = (const unsigned char *)str; *c; c++) {
+        if (*c == '"' || *c == '\\') {
+            writer_putc(out, '\\');
+            writer_putc(out, (char)*c);
+        } else if (*c < 0x20) {
+            writer_puts(out, "\\u00");
+            writer_putc(out, hex[*c >> 4]);
+            writer_putc(out, hex[*c & 0xf]);
+        } else {
+            writer_putc(out, (char)*c);
+        }
+    }
+
+    writer_putc(out, '"');
+}
+
+// Write a course list with its totals to stdout
+bool report_courses(const courselist_t *courses, report_format_t format) {
+    if (format == REPORT_TEXT)
+        return display_grades(courses);
+
+    char stack_buf[WRITER_STACK_BUF_LEN];
+    char *buf = malloc(WRITER_REPORT_BUF_LEN);
+    writer_t out;
+
+    if (buf)
+        writer_init(&out, STDOUT_FILENO, buf, WRITER_REPORT_BUF_LEN);
+    else
+        writer_init(&out, STDOUT_FILENO, stack_buf, sizeof stack_buf);
+
+    cgpa_totals_t totals = cgpa_current(courses);
+
+    if (format == REPORT_CSV)
+        writer_puts(&out, "type,course_code,course_weight,letter_grade,credits_earned,cgpa\n");
+    else
+        writer_puts(&out, "{\"courses\":[");
+
+    for (const coursenode_t *curr = courses->head; curr; curr = curr->next) {
+        char course_code[COURSE_CODE_BUF_LEN];
+        course_key_to_code(curr->key, course_code);
+        const char *letter_grade = grade_to_string((grade_t)curr->grade);
+
+        if (format == REPORT_CSV) {
+            writer_puts(&out, "course,");
+            writer_puts(&out, course_code);
+            writer_putc(&out, ',');
+            writer_fixed(&out, curr->course_weight, 2, 0);
+            writer_putc(&out, ',');
+            writer_puts(&out, letter_grade);
+            writer_putc(&out, ',');
+            writer_fixed(&out, curr->credits_earned, 2, 0);
+            writer_puts(&out, ",\n");
+        } else {
+            writer_puts(&out, curr == courses->head ? "{\"code\":\"" : ",{\"code\":\"");
+            writer_puts(&out, course_code);
+            writer_puts(&out, "\",\"weight\":");
+            writer_fixed(&out, curr->course_weight, 2, 0);
+            writer_puts(&out, ",\"grade\":\"");
+            writer_puts(&out, letter_grade);
+            writer_puts(&out, "\",\"credits\":");
+            writer_fixed(&out, curr->credits_earned, 2, 0);
+            writer_putc(&out, '}');
+        }
+    }
+
+    if (format == REPORT_CSV) {
+        writer_puts(&out, "total,,");
+        writer_fixed(&out, totals.credits_completed, 2, 0);
+        writer_puts(&out, ",,");
+        writer_fixed(&out, totals.credits_earned, 2, 0);
+        writer_putc(&out, ',');
+        writer_fixed(&out, totals.cgpa, 4, 0);
+        writer_putc(&out, '\n');
+    } else {
+        writer_puts(&out, "],\"totals\":{\"credits_earned\":");
+        writer_fixed(&out, totals.credits_earned, 2, 0);
+        writer_puts(&out, ",\"credits_completed\":");
+        writer_fixed(&out, totals.credits_completed, 2, 0);
+        writer_puts(&out, ",\"cgpa\":");
+        writer_fixed(&out, totals.cgpa, 4, 0);
+        writer_puts(&out, "}}\n");
+    }
+
+    bool ok = writer_flush(&out);
+    free(buf);
+
+    return ok;
+}
+
+// One term's row: courses, credits, term GPA and CGPA through the term
+static void report_term(writer_t *out, const courselist_t *courses, term_t term,
+                        report_format_t format, bool first) {
+    char term_buf[TERM_BUF_LEN];
+    size_t count;
+    cgpa_totals_t totals = cgpa_term(courses, term, &count);
+    cgpa_totals_t cumulative = cgpa_through_term(courses, term, NULL);
+
+    term_to_string(term, term_buf);
+
+    if (format == REPORT_TEXT) {
+        // "  %-6s %7zu %15.2f %18.2f %8.2f %5.2f\n"
+        writer_puts(out, "  ");
+        writer_pad_right(out, term_buf, 6);
+        writer_putc(out, ' ');
+        writer_uint(out, count, 7);
+        writer_putc(out, ' ');
+        writer_fixed(out, totals.credits_earned, 2, 15);
+        writer_putc(out, ' ');
+        writer_fixed(out, totals.credits_completed, 2, 18);
+        writer_putc(out, ' ');
+        writer_fixed(out, totals.cgpa, 2, 8);
+        writer_putc(out, ' ');
+        writer_fixed(out, cumulative.cgpa, 2, 5);
+        writer_putc(out, '\n');
+        return;
+    }
+
+    if (format == REPORT_CSV) {
+        writer_puts(out, term_buf);
+        writer_putc(out, ',');
+    } else {
+        writer_puts(out, first ? "{\"term\":\"" : ",{\"term\":\"");
+        writer_puts(out, term_buf);
+        writer_puts(out, "\",\"courses\":");
+    }
+
+    writer_uint(out, count, 0);
+    writer_puts(out, format == REPORT_CSV ? "," : ",\"credits_earned\":");
+    writer_fixed(out, totals.credits_earned, 2, 0);
+    writer_puts(out, format == REPORT_CSV ? "," : ",\"credits_completed\":");
+    writer_fixed(out, totals.credits_completed, 2, 0);
+    writer_puts(out, format == REPORT_CSV ? "," : ",\"gpa\":");
+    writer_fixed(out, totals.cgpa, 4, 0);
+    writer_puts(out, format == REPORT_CSV ? "," : ",\"cgpa\":");
+    writer_fixed(out, cumulative.cgpa, 4, 0);
+    writer_puts(out, format == REPORT_CSV ? "\n" : "}");
+}
+
+// Write per-term GPAs to stdout, for one term or every term with courses
+bool report_terms(const courselist_t *courses, term_t term, report_format_t format) {
+    char buf[WRITER_STACK_BUF_LEN];
+    writer_t out;
+    size_t rows = 0;
+
+    writer_init(&out, STDOUT_FILENO, buf, sizeof buf);
+
+    if (format == REPORT_TEXT)
+        writer_puts(&out, SEPERATOR1 "  Term   Courses  Credits Earned  Credits Completed  Term GPA"
+                                     "  CGPA\n");
+    else if (format == REPORT_CSV)
+        writer_puts(&out, "term,courses,credits_earned,credits_completed,gpa,cgpa\n");
+    else
+        writer_puts(&out, "{\"terms\":[");
+
+    term_t first = term == TERM_NONE ? 1 : term;
+    term_t last = term == TERM_NONE ? TERM_COUNT : term;
+
+    for (term_t t = first; t <= last; t++) {
+        size_t count;
+
+        // Each probe is O(log TERM_COUNT), so scanning every term is cheap
+        cgpa_term(courses, t, &count);
+        if (count == 0 && term == TERM_NONE)
+            continue;
+
+        report_term(&out, courses, t, format, rows++ == 0);
+    }
+
+    if (format == REPORT_TEXT) {
+        writer_puts(&out, "\n  Terms: ");
+        writer_uint(&out, rows, 0);
+        writer_puts(&out, "\n" SEPERATOR2);
+    } else if (format == REPORT_JSON) {
+        writer_puts(&out, "]}\n");
+    }
+
+    return writer_flush(&out);
+}
+
+// One code range's row: courses, credits and GPA
+static void report_subject(writer_t *out, const courselist_t *courses, const char *label,
+                           course_key_t first, course_key_t last, report_format_t format,
+                           bool first_row) {
+    size_t count;
+    cgpa_totals_t totals = cgpa_range(courses, first, last, &count);
+
+    if (format == REPORT_TEXT) {
+        // "  %-17s %7zu %15.2f %18.2f %8.2f\n"
+        writer_puts(out, "  ");
+        writer_pad_right(out, label, 17);
+        writer_putc(out, ' ');
+        writer_uint(out, count, 7);
+        writer_putc(out, ' ');
+        writer_fixed(out, totals.credits_earned, 2, 15);
+        writer_putc(out, ' ');
+        writer_fixed(out, totals.credits_completed, 2, 18);
+        writer_putc(out, ' ');
+        writer_fixed(out, totals.cgpa, 2, 8);
+        writer_putc(out, '\n');
+        return;
+    }
+
+    if (format == REPORT_CSV) {
+        csv_field(out, label);
+        writer_putc(out, ',');
+    } else {
+        writer_puts(out, first_row ? "{\"subject\":" : ",{\"subject\":");
+        json_string(out, label);
+        writer_puts(out, ",\"courses\":");
+    }
+
+    writer_uint(out, count, 0);
+    writer_puts(out, format == REPORT_CSV ? "," : ",\"credits_earned\":");
+    writer_fixed(out, totals.credits_earned, 2, 0);
+    writer_puts(out, format == REPORT_CSV ? "," : ",\"credits_completed\":");
+    writer_fixed(out, totals.credits_completed, 2, 0);
+    writer_puts(out, format == REPORT_CSV ? "," : ",\"gpa\":");
+    writer_fixed(out, totals.cgpa, 4, 0);
+    writer_puts(out, format == REPORT_CSV ? "\n" : "}");
+}
+
+// Write per-subject GPAs to stdout, for the given ranges or every subject
+bool report_subjects(const courselist_t *courses, const char *specs, report_format_t format) {
+    char buf[WRITER_STACK_BUF_LEN];
+    writer_t out;
+    size_t rows = 0;
+
+    writer_init(&out, STDOUT_FILENO, buf, sizeof buf);
+
+    if (format == REPORT_TEXT)
+        writer_puts(&out, SEPERATOR1 "  Subject            Courses  Credits Earned"
+                                     "  Credits Completed       GPA\n");
+    else if (format == REPORT_CSV)
+        writer_puts(&out, "subject,courses,credits_earned,credits_completed,gpa\n");
+    else
+        writer_puts(&out, "{\"subjects\":[");
+
+    if (!specs) {
+        // Jump from subject to subject: O(log n) each, however many courses it has
+        const course_key_t subject_span = (course_key_t)1 << COURSE_KEY_NUMBER_BITS;
+        char label[COURSE_CODE_BUF_LEN];
+
+        for (const coursenode_t *node = fetch_node_from(courses, 0); node;) {
+            course_key_t first = COURSE_KEY_SUBJECT(node->key) << COURSE_KEY_NUMBER_BITS;
+
+            course_key_to_code(first, label);
+            label[4] = '\0';
+            report_subject(&out, courses, label, first, first + subject_span - 1, format,
+                           rows++ == 0);
+            node = fetch_node_from(courses, first + subject_span);
+        }
+    }
+
+    for (const char *spec = specs; spec && *spec;) {
+        size_t len = strcspn(spec, ",");
+        char label[2 * COURSE_CODE_BUF_LEN];
+        course_key_t first, last;
+
+        if (len < sizeof label && course_key_range_from_chars(spec, len, &first, &last)) {
+            for (size_t i = 0; i < len; i++)
+                label[i] = (char)toupper((unsigned char)spec[i]);
+            label[len] = '\0';
+            report_subject(&out, courses, label, first, last, format, rows++ == 0);
+        }
+
+        spec += len + (spec[len] == ',');
+    }
+
+    if (format == REPORT_TEXT) {
+        writer_puts(&out, "\n  Rows: ");
+        writer_uint(&out, rows, 0);
+        writer_puts(&out, "\n" SEPERATOR2);
+    } else if (format == REPORT_JSON) {
+        writer_puts(&out, "]}\n");
+    }
+
+    return writer_flush(&out);
+}
+
+// Write a what-if plan to stdout
+bool report_whatif(const grading_scale_t *scale, const float *weights, const grade_t *grades,
+                   size_t count, double target, whatif_status_t status,
+                   const whatif_result_t *result, report_format_t format) {
+    if (format == REPORT_TEXT)
+        return display_whatif(scale, weights, grades, count, target, status, result);
+
+    const float *points = scale_points(scale);
+    char buf[WRITER_STACK_BUF_LEN];
+    writer_t out;
+    double planned = 0.0;
+
+    writer_init(&out, STDOUT_FILENO, buf, sizeof buf);
+
+    if (format == REPORT_CSV)
+        writer_puts(&out, "type,course_weight,letter_grade,credits_earned,cgpa\n");
+    else
+        writer_puts(&out, "{\"courses\":[");
+
+    for (size_t i = 0; i < count; i++) {
+        const char *letter_grade = grade_to_string(grades[i]);
+
+        planned += weights[i];
+
+        if (format == REPORT_CSV) {
+            writer_puts(&out, "course,");
+            writer_fixed(&out, weights[i], 2, 0);
+            writer_putc(&out, ',');
+            writer_puts(&out, letter_grade);
+            writer_putc(&out, ',');
+            writer_fixed(&out, points[grades[i]] * weights[i], 2, 0);
+            writer_puts(&out, ",\n");
+        } else {
+            writer_puts(&out, i ? ",{\"weight\":" : "{\"weight\":");
+            writer_fixed(&out, weights[i], 2, 0);
+            writer_puts(&out, ",\"grade\":\"");
+            writer_puts(&out, letter_grade);
+            writer_puts(&out, "\",\"credits\":");
+            writer_fixed(&out, points[grades[i]] * weights[i], 2, 0);
+            writer_putc(&out, '}');
+        }
+    }
+
+    // The uniform grade rides in the total row's grade column
+    const char *uniform = result->uniform == GRADE_INVALID ? "" : grade_to_string(result->uniform);
+
+    if (format == REPORT_CSV) {
+        writer_puts(&out, "total,");
+        writer_fixed(&out, planned, 2, 0);
+        writer_putc(&out, ',');
+        writer_puts(&out, uniform);
+        writer_putc(&out, ',');
+        writer_fixed(&out, result->credits_earned, 2, 0);
+        writer_putc(&out, ',');
+        writer_fixed(&out, result->cgpa, 4, 0);
+        writer_putc(&out, '\n');
+    } else {
+        writer_puts(&out, "],\"target\":");
+        writer_fixed(&out, target, 4, 0);
+        writer_puts(&out, status == WHATIF_UNREACHABLE ? ",\"reachable\":false"
+                                                       : ",\"reachable\":true");
+        writer_puts(&out, result->optimal ? ",\"optimal\":true" : ",\"optimal\":false");
+        writer_puts(&out, ",\"uniform\":");
+        if (result->uniform == GRADE_INVALID) {
+            writer_puts(&out, "null");
+        } else {
+            writer_putc(&out, '"');
+            writer_puts(&out, uniform);
+            writer_putc(&out, '"');
+        }
+        writer_puts(&out, ",\"totals\":{\"credits_earned\":");
+        writer_fixed(&out, result->credits_earned, 2, 0);
+        writer_puts(&out, ",\"cgpa\":");
+        writer_fixed(&out, result->cgpa, 4, 0);
+        writer_puts(&out, "}}\n");
+    }
+
+    return writer_flush(&out);
+}
+
+// Write per-student totals to stdout, sorted by student ID
+bool report_cohort(const cohort_t *cohort, report_format_t format) {
+    if (format == REPORT_TEXT)
+        return display_cohort(cohort);
+
+    const student_totals_t **sorted = cohort_sorted(cohort);
+    if (!sorted)
+        return false;
+
+    char stack_buf[WRITER_STACK_BUF_LEN];
+    char *buf = malloc(WRITER_REPORT_BUF_LEN);
+    writer_t out;
+
+    if (buf)
+        writer_init(&out, STDOUT_FILENO, buf, WRITER_REPORT_BUF_LEN);
+    else
+        writer_init(&out, STDOUT_FILENO, stack_buf, sizeof stack_buf);
+
+    if (format == REPORT_CSV)
+        writer_puts(&out, "student_id,courses,credits_earned,credits_completed,cgpa\n");
+    else
+        writer_puts(&out, "{\"students\":[");
+
+    for (size_t i = 0; i < cohort->count; i++) {
+        const student_totals_t *student = sorted[i];
+
+        if (format == REPORT_CSV) {
+            csv_field(&out, student->student_id);
+            writer_putc(&out, ',');
+        } else {
+            writer_puts(&out, i ? ",{\"id\":" : "{\"id\":");
+            json_string(&out, student->student_id);
+            writer_puts(&out, ",\"courses\":");
+        }
+
+        writer_uint(&out, student->courses, 0);
+        writer_puts(&out, format == REPORT_CSV ? "," : ",\"credits_earned\":");
+        writer_fixed(&out, student->credits_earned, 2, 0);
+        writer_puts(&out, format == REPORT_CSV ? "," : ",\"credits_completed\":");
+        writer_fixed(&out, student->credits_completed, 2, 0);
+        writer_puts(&out, format == REPORT_CSV ? "," : ",\"cgpa\":");
+        writer_fixed(&out, student_cgpa(student), 4, 0);
+        writer_puts(&out, format == REPORT_CSV ? "\n" : "}");
+    }
+
+    if (format == REPORT_JSON) {
+        writer_puts(&out, "],\"count\":");
+        writer_uint(&out, cohort->count, 0);
+        writer_puts(&out, "}\n");
+    }
+
+    bool ok = writer_flush(&out);
+    free(buf);
+    free(sorted);
+
+    return ok;
+}
+
+// Write streamed totals to stdout
+bool report_totals(const cgpa_totals_t *totals, const stream_stats_t *stats,
+                   report_format_t format) {
+    char buf[WRITER_STACK_BUF_LEN];
+    writer_t out;
+
+    writer_init(&out, STDOUT_FILENO, buf, sizeof buf);
+
+    if (format == REPORT_TEXT) {
+        writer_puts(&out, SEPERATOR1 "  Courses Counted: ");
+        writer_uint(&out, stats->load.records, 0);
+        writer_puts(&out, " (");
+        writer_uint(&out, stats->load.skipped, 0);
+        writer_puts(&out, " lines skipped, ");
+        writer_uint(&out, stats->duplicates, 0);
+        writer_puts(&out, " duplicates)\n\n  Total Credits Earned: ");
+        writer_fixed(&out, totals->credits_earned, 2, 4);
+        writer_puts(&out, "\n  Total Credits Completed: ");
+        writer_fixed(&out, totals->credits_completed, 2, 4);
+        writer_puts(&out, "\n\n  Current CGPA: ");
+        writer_fixed(&out, totals->cgpa, 2, 4);
+        writer_puts(&out, "\n" SEPERATOR2);
+        return writer_flush(&out);
+    }
+
+    if (format == REPORT_CSV)
+        writer_puts(&out, "courses,skipped,duplicates,credits_earned,credits_completed,cgpa\n");
+    else
+        writer_puts(&out, "{\"courses\":");
+
+    writer_uint(&out, stats->load.records, 0);
+    writer_puts(&out, format == REPORT_CSV ? "," : ",\"skipped\":");
+    writer_uint(&out, stats->load.skipped, 0);
+    writer_puts(&out, format == REPORT_CSV ? "," : ",\"duplicates\":");
+    writer_uint(&out, stats->duplicates, 0);
+    writer_puts(&out, format == REPORT_CSV ? "," : ",\"totals\":{\"credits_earned\":");
+    writer_fixed(&out, totals->credits_earned, 2, 0);
+    writer_puts(&out, format == REPORT_CSV ? "," : ",\"credits_completed\":");
+    writer_fixed(&out, totals->credits_completed, 2, 0);
+    writer_puts(&out, format == REPORT_CSV ? "," : ",\"cgpa\":");
+    writer_fixed(&out, totals->cgpa, 4, 0);
+    writer_puts(&out, format == REPORT_CSV ? "\n" : "}}\n");
+
+    return writer_flush(&out);
+}
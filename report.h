@@ -0,0 +1,86 @@
+/***********************************
+ * report.h
+ *
+ * CGPA Calculator - machine-readable reports
+ *
+ * Defines:
+ * - report formats (text, CSV, JSON)
+ * - course list, term, subject, what-if and cohort report writers
+ *
+ * Author: Arul Rao (Vidonicle)
+ * License: MIT
+ ***********************************/
+
+#ifndef REPORT_H
+#define REPORT_H
+
+#include <stdbool.h>
+
+#include "batch.h"
+#include "courselist.h"
+#include "stream.h"
+#include "whatif.h"
+
+typedef enum {
+    REPORT_TEXT = 0,  // Same layout as the interactive display
+    REPORT_CSV,
+    REPORT_JSON
+} report_format_t;
+
+bool report_format_from_string(const char *name, report_format_t *format);
+
+/*
+ * Write a course list with its totals to stdout.
+ * CSV rows start with a type column: "course" rows, then one "total" row.
+ *
+ * Returns false if output failed.
+ */
+bool report_courses(const courselist_t *courses, report_format_t format);
+
+/*
+ * Write the GPA of term and the CGPA through it to stdout; TERM_NONE
+ * writes every term that has courses, in time order. Courses without a
+ * term are not counted.
+ *
+ * Returns false if output failed.
+ */
+bool report_terms(const courselist_t *courses, term_t term, report_format_t format);
+
+/*
+ * Write the GPA of each comma-separated code range in specs (see
+ * course_key_range_from_string, e.g. "SYSC,SYSC2,COMP1000-COMP2999") to
+ * stdout; NULL writes every subject that has courses, in code order.
+ * Specs that are not ranges are skipped.
+ *
+ * Returns false if output failed.
+ */
+bool report_subjects(const courselist_t *courses, const char *specs, report_format_t format);
+
+/*
+ * Write a what-if plan to stdout: each planned weight with its grade,
+ * then the plan's totals. CSV rows start with a type column, as in
+ * report_courses.
+ *
+ * Returns false if output failed.
+ */
+bool report_whatif(const grading_scale_t *scale, const float *weights, const grade_t *grades,
+                   size_t count, double target, whatif_status_t status,
+                   const whatif_result_t *result, report_format_t format);
+
+/*
+ * Write per-student totals to stdout, sorted by student ID.
+ *
+ * Returns false on allocation or output failure.
+ */
+bool report_cohort(const cohort_t *cohort, report_format_t format);
+
+/*
+ * Write totals from stream_totals to stdout, with the record, skipped
+ * and duplicate counts.
+ *
+ * Returns false if output failed.
+ */
+bool report_totals(const cgpa_totals_t *totals, const stream_stats_t *stats,
+                   report_format_t format);
+
+#endif /* REPORT_H */
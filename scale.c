@@ -0,0 +1,231 @@
+/***********************************
+ * scale.c
+ *
+ * CGPA Calculator - grading scales
+ *
+ * Handles:
+ * - the built-in Carleton scale
+ * - parsing grading scale files into dense tables
+ * - grade and weight checks against a scale
+ *
+ * Author: Arul Rao (Vidonicle)
+ * License: MIT
+ ***********************************/
+#define _POSIX_C_SOURCE 200809L
+
+#include "scale.h"
+
+#include <ctype.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cgpa.h"
+
+#define SCALE_LINE_LEN 256  // Longest line in a scale file
+
+static const grading_scale_t carleton_scale = {
+    .name = SCALE_DEFAULT_NAME,
+    .points = {12.0f, 11.0f, 10.0f, 9.0f, 8.0f, 7.0f, 6.0f, 5.0f, 4.0f, 3.0f, 2.0f, 1.0f, 0.0f,
+               0.0f},
+    .defined = {true, true, true, true, true, true, true, true, true, true, true, true, true},
+    .max_points = 12.0f,
+    .weights = {1.0f, 0.5f, 0.25f},
+    .weight_count = 3,
+};
+
+const grading_scale_t *scale_default(void) {
+    return &carleton_scale;
+}
+
+const float *scale_points(const grading_scale_t *scale) {
+    return (scale ? scale : &carleton_scale)->points;
+}
+
+const char *scale_name(const grading_scale_t *scale) {
+    return (scale ? scale : &carleton_scale)->name;
+}
+
+float scale_max_points(const grading_scale_t *scale) {
+    return (scale ? scale : &carleton_scale)->max_points;
+}
+
+bool scale_accepts_grade(const grading_scale_t *scale, grade_t grade) {
+    return grade < GRADE_COUNT && (scale ? scale : &carleton_scale)->defined[grade];
+}
+
+bool scale_accepts_weight(const grading_scale_t *scale, float course_weight) {
+    if (!scale)
+        scale = &carleton_scale;
+
+    // NaN fails both comparisons
+    if (scale->weight_count == 0)
+        return course_weight > 0.0f && course_weight <= SCALE_WEIGHT_MAX;
+
+    for (size_t i = 0; i < scale->weight_count; i++) {
+        if (course_weight == scale->weights[i])
+            return true;
+    }
+
+    return false;
+}
+
+// Parse a whole token as a number from 0 to limit
+static bool parse_number(const char *tok, float limit, float *value) {
+    char *endptr;
+    *value = strtof(tok, &endptr);
+
+    return endptr != tok && *endptr == '\0' && *value >= 0.0f && *value <= limit;
+}
+
+// Scale is complete once it has a letter; its max covers every letter
+static bool scale_finish(grading_scale_t *scale, bool max_set) {
+    bool any = false;
+    float highest = 0.0f;
+
+    for (size_t g = 0; g < GRADE_COUNT; g++) {
+        if (!scale->defined[g])
+            continue;
+        any = true;
+        if (scale->points[g] > highest)
+            highest = scale->points[g];
+    }
+
+    if (!max_set)
+        scale->max_points = highest;
+
+    return any && highest <= scale->max_points && scale->max_points > 0.0f;
+}
+
+static scale_status_t scale_begin(scale_set_t *set, const char *name, size_t len) {
+    if (len == 0 || len >= SCALE_NAME_LEN)
+        return SCALE_ERR_FORMAT;
+
+    for (size_t i = 0; i < set->count; i++) {
+        if (strncmp(set->scales[i].name, name, len) == 0 && set->scales[i].name[len] == '\0')
+            return SCALE_ERR_FORMAT;
+    }
+
+    grading_scale_t *scales = realloc(set->scales, (set->count + 1) * sizeof(grading_scale_t));
+    if (!scales)
+        return SCALE_ERR_OOM;
+
+    set->scales = scales;
+
+    grading_scale_t *scale = &set->scales[set->count++];
+    memset(scale, 0, sizeof *scale);
+    memcpy(scale->name, name, len);
+
+    return SCALE_OK;
+}
+
+// Parse one non-section line into the current scale
+static bool scale_line(grading_scale_t *scale, char *line, bool *max_set) {
+    char *save;
+    char *key = strtok_r(line, " \t", &save);
+    char *tok;
+    float value;
+
+    if (strcmp(key, "max") == 0) {
+        tok = strtok_r(NULL, " \t", &save);
+        if (!tok || !parse_number(tok, SCALE_POINTS_MAX, &scale->max_points) ||
+            strtok_r(NULL, " \t", &save))
+            return false;
+        *max_set = true;
+        return true;
+    }
+
+    if (strcmp(key, "weights") == 0) {
+        scale->weight_count = 0;
+
+        while ((tok = strtok_r(NULL, " \t", &save))) {
+            if (scale->weight_count == SCALE_MAX_WEIGHTS ||
+                !parse_number(tok, SCALE_WEIGHT_MAX, &value) || value == 0.0f)
+                return false;
+            scale->weights[scale->weight_count++] = value;
+        }
+
+        return scale->weight_count > 0;
+    }
+
+    key[0] = (char)toupper((unsigned char)key[0]);
+    grade_t grade = grade_from_string(key);
+
+    tok = strtok_r(NULL, " \t", &save);
+    if (grade == GRADE_INVALID || !tok || !parse_number(tok, SCALE_POINTS_MAX, &value) ||
+        strtok_r(NULL, " \t", &save))
+        return false;
+
+    scale->points[grade] = value;
+    scale->defined[grade] = true;
+
+    return true;
+}
+
+// Add every scale in a file to set
+scale_status_t scale_set_load(scale_set_t *set, FILE *fptr, size_t *line) {
+    char buf[SCALE_LINE_LEN];
+    grading_scale_t *scale = NULL;
+    bool max_set = false;
+    size_t first = set->count;
+
+    *line = 0;
+
+    while (fgets(buf, sizeof buf, fptr)) {
+        (*line)++;
+
+        if (!strchr(buf, '\n') && !feof(fptr))
+            return SCALE_ERR_FORMAT;
+
+        char *p = buf;
+        while (isspace((unsigned char)*p))
+            p++;
+
+        char *end = p + strcspn(p, "#\r\n");
+        while (end > p && isspace((unsigned char)end[-1]))
+            end--;
+        *end = '\0';
+
+        if (*p == '\0')
+            continue;
+
+        if (*p == '[') {
+            if (scale && !scale_finish(scale, max_set))
+                return SCALE_ERR_FORMAT;
+            if (end[-1] != ']')
+                return SCALE_ERR_FORMAT;
+
+            scale_status_t status = scale_begin(set, p + 1, (size_t)(end - p - 2));
+            if (status != SCALE_OK)
+                return status;
+
+            scale = &set->scales[set->count - 1];
+            max_set = false;
+        } else if (!scale || !scale_line(scale, p, &max_set)) {
+            return SCALE_ERR_FORMAT;
+        }
+    }
+
+    if (ferror(fptr) || set->count == first || !scale_finish(scale, max_set))
+        return SCALE_ERR_FORMAT;
+
+    return SCALE_OK;
+}
+
+// Scale called name; loaded scales take precedence over the built-in one
+const grading_scale_t *scale_set_find(const scale_set_t *set, const char *name) {
+    for (size_t i = 0; set && i < set->count; i++) {
+        if (strcmp(set->scales[i].name, name) == 0)
+            return &set->scales[i];
+    }
+
+    return strcmp(name, SCALE_DEFAULT_NAME) == 0 ? &carleton_scale : NULL;
+}
+
+void scale_set_free(scale_set_t *set) {
+    free(set->scales);
+    set->scales = NULL;
+    set->count = 0;
+}
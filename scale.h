@@ -0,0 +1,84 @@
+/***********************************
+ * scale.h
+ *
+ * CGPA Calculator - grading scales
+ *
+ * Defines:
+ * - per-institution grading scale tables
+ * - the grading scale file format and loader
+ *
+ * Author: Arul Rao (Vidonicle)
+ * License: MIT
+ ***********************************/
+
+#ifndef SCALE_H
+#define SCALE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#include "cgpa.h"
+
+#define SCALE_NAME_LEN 32     // Including '\0'
+#define SCALE_MAX_WEIGHTS 16  // Accepted weights per scale
+#define SCALE_WEIGHT_MAX 100.0f   // Largest course weight any scale accepts
+#define SCALE_POINTS_MAX 1000.0f  // Largest grade points any scale defines
+#define SCALE_DEFAULT_NAME "carleton"
+
+/*
+ * A grading scale compiled to dense tables indexed by grade_t, so
+ * per-course lookups are a single load with no string handling.
+ */
+struct grading_scale {
+    char name[SCALE_NAME_LEN];
+    float points[GRADE_COUNT + 1];     // Points per unit of weight; GRADE_INVALID earns 0
+    bool defined[GRADE_COUNT];         // Letters the scale accepts from the menu
+    float max_points;                  // Highest possible CGPA
+    float weights[SCALE_MAX_WEIGHTS];  // Weights the menu accepts
+    size_t weight_count;               // 0 = any weight in (0, SCALE_WEIGHT_MAX]
+};
+
+typedef struct {
+    grading_scale_t *scales;
+    size_t count;
+} scale_set_t;
+
+typedef enum {
+    SCALE_OK = 0,
+    SCALE_ERR_FORMAT,  // Bad line, value or duplicate name
+    SCALE_ERR_OOM
+} scale_status_t;
+
+// Built-in Carleton University 12-point scale
+const grading_scale_t *scale_default(void);
+
+// Dense points table for scale (NULL = default), indexed by grade_t
+const float *scale_points(const grading_scale_t *scale);
+
+const char *scale_name(const grading_scale_t *scale);
+
+float scale_max_points(const grading_scale_t *scale);
+
+bool scale_accepts_grade(const grading_scale_t *scale, grade_t grade);
+
+bool scale_accepts_weight(const grading_scale_t *scale, float course_weight);
+
+/*
+ * Add every scale in a file to set. Format, one item per line:
+ *   [name]          start a scale
+ *   max 4.0         highest grade points (default: largest listed)
+ *   weights 0.5 1   accepted course weights (default: any)
+ *   A+ 4.0          points for a letter; unlisted letters are not accepted
+ * Blank lines and '#' comments are skipped.
+ *
+ * On SCALE_ERR_FORMAT, *line is the offending line number.
+ */
+scale_status_t scale_set_load(scale_set_t *set, FILE *fptr, size_t *line);
+
+// Scale called name; the built-in scale is found unless the set overrides it
+const grading_scale_t *scale_set_find(const scale_set_t *set, const char *name);
+
+void scale_set_free(scale_set_t *set);
+
+#endif /* SCALE_H */
@@ -0,0 +1,638 @@
+/***********************************
+ * server.c
+ *
+ * CGPA Calculator - query daemon
+ *
+ * Handles:
+ * - Unix socket and localhost TCP listeners
+ * - an epoll loop over non-blocking clients
+ * - parsing requests and queueing replies
+ * - shutdown on SIGINT / SIGTERM
+ *
+ * Author: Arul Rao (Vidonicle)
+ * License: MIT
+ ***********************************/
+#define _POSIX_C_SOURCE 200809L
+
+#include "server.h"
+
+#include <arpa/inet.h>
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "cgpa.h"
+#include "instrument.h"
+
+#define SERVER_EVENTS 64     // epoll events handled per wakeup
+#define SERVER_REPLY_MAX 96  // Longest reply line
+#define SERVER_MAX_FIELDS 5  // Op plus at most four arguments
+
+typedef struct client {
+    int fd;
+    uint32_t events;  // Currently registered with epoll
+    bool closing;     // Close once every reply is sent
+
+    char in[SERVER_LINE_MAX];
+    size_t in_len;
+
+    char *out;        // Queued replies
+    size_t out_len;
+    size_t out_sent;  // Prefix of out already sent
+    size_t out_cap;
+
+    struct client *prev, *next;  // Every open client, for shutdown
+} client_t;
+
+// Listener and signal state owned by one server_run call
+typedef struct {
+    int epoll_fd;
+    int listen_fd;
+    int signal_fd;
+    bool tcp;
+    const char *unix_path;  // Removed on shutdown
+    client_t *clients;
+} server_t;
+
+static bool set_nonblocking(int fd) {
+    int flags = fcntl(fd, F_GETFL);
+
+    return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+// A port is 1-5 digits in 1..65535
+static bool parse_port(const char *address, uint16_t *port) {
+    unsigned long value = 0;
+    size_t len = strlen(address);
+
+    if (len == 0 || len > 5)
+        return false;
+
+    for (size_t i = 0; i < len; i++) {
+        if (!isdigit((unsigned char)address[i]))
+            return false;
+        value = value * 10 + (unsigned long)(address[i] - '0');
+    }
+
+    *port = (uint16_t)value;
+    return value > 0 && value <= UINT16_MAX;
+}
+
+static int listen_tcp(uint16_t port) {
+    struct sockaddr_in addr = {0};
+    int one = 1;
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+
+    if (fd < 0)
+        return -1;
+
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    if (setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof one) != 0 ||
+        bind(fd, (struct sockaddr *)&addr, sizeof addr) != 0) {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+// A stale socket from an earlier run is replaced; any other file is kept
+static int listen_unix(const char *path) {
+    struct sockaddr_un addr = {0};
+    struct stat st;
+
+    if (strlen(path) >= sizeof addr.sun_path)
+        return -1;
+    if (lstat(path, &st) == 0 && S_ISSOCK(st.st_mode))
+        unlink(path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+        return -1;
+
+    addr.sun_family = AF_UNIX;
+    memcpy(addr.sun_path, path, strlen(path) + 1);
+
+    if (bind(fd, (struct sockaddr *)&addr, sizeof addr) != 0) {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+static bool server_listen(server_t *server, const char *address) {
+    uint16_t port;
+
+    server->tcp = parse_port(address, &port);
+    server->listen_fd = server->tcp ? listen_tcp(port) : listen_unix(address);
+    if (server->listen_fd < 0)
+        return false;
+
+    if (!server->tcp)
+        server->unix_path = address;
+
+    return listen(server->listen_fd, SERVER_BACKLOG) == 0 && set_nonblocking(server->listen_fd);
+}
+
+// Queue one reply line; false if out of memory
+static bool client_reply(client_t *client, const char *reply) {
+    size_t len = strlen(reply);
+
+    if (client->out_len + len + 1 > client->out_cap) {
+        size_t cap = client->out_cap ? client->out_cap * 2 : SERVER_REPLY_MAX * 16;
+
+        while (cap < client->out_len + len + 1)
+            cap *= 2;
+
+        char *out = realloc(client->out, cap);
+        if (!out)
+            return false;
+
+        client->out = out;
+        client->out_cap = cap;
+    }
+
+    memcpy(client->out + client->out_len, reply, len);
+    client->out[client->out_len + len] = '\n';
+    client->out_len += len + 1;
+
+    return true;
+}
+
+static const char *status_reason(cgpa_status_t status) {
+    switch (status) {
+        case CGPA_ERR_CODE:
+            return "ERR code";
+        case CGPA_ERR_WEIGHT:
+            return "ERR weight";
+        case CGPA_ERR_GRADE:
+            return "ERR grade";
+        case CGPA_ERR_TERM:
+            return "ERR term";
+        case CGPA_ERR_NOT_FOUND:
+            return "ERR not-found";
+        case CGPA_ERR_EXISTS:
+            return "ERR exists";
+        case CGPA_ERR_OOM:
+            return "ERR oom";
+        case CGPA_OK:
+        default:
+            return "OK";
+    }
+}
+
+// Weight field: "-" keeps the current weight (-1), otherwise a number >= 0
+static bool parse_weight(const char *field, bool allow_keep, float *course_weight) {
+    char *endptr;
+
+    if (allow_keep && strcmp(field, "-") == 0) {
+        *course_weight = -1.0f;
+        return true;
+    }
+
+    *course_weight = strtof(field, &endptr);
+    return endptr != field && *endptr == '\0' && *course_weight >= 0.0f;
+}
+
+// Letter fields are accepted in either case, as in the menu
+static char *grade_field(char *field) {
+    field[0] = (char)toupper((unsigned char)field[0]);
+    return field;
+}
+
+// Term field: W2025, S2025 or F2025, in either case
+static cgpa_status_t term_field(const char *field, term_t *term) {
+    *term = term_from_string(field);
+    return *term == TERM_NONE ? CGPA_ERR_TERM : CGPA_OK;
+}
+
+static void totals_reply(char *reply, size_t count, cgpa_totals_t totals) {
+    snprintf(reply, SERVER_REPLY_MAX, "OK %zu %.2f %.2f %.2f", count, totals.credits_earned,
+             totals.credits_completed, totals.cgpa);
+}
+
+// "-" keeps a code or grade
+static const char *keep_field(const char *field) {
+    return strcmp(field, "-") == 0 ? NULL : field;
+}
+
+// As in the menu, a code can only be in the transcript once
+static bool course_exists(const cgpa_transcript_t *transcript, const char *course_code) {
+    cgpa_course_t course;
+
+    return cgpa_transcript_query(transcript, course_code, &course) == CGPA_OK;
+}
+
+/*
+ * Run one parsed request, writing any OK fields to reply. Returns false
+ * if the line is not a request at all.
+ */
+static bool run_request(cgpa_transcript_t *transcript, char **fields, size_t count, char *reply,
+                        cgpa_status_t *status) {
+    const char *op = fields[0];
+    float course_weight;
+    term_t term = TERM_NONE;
+    size_t covered;
+
+    if (op[1] != '\0')
+        return false;
+
+    switch (op[0]) {
+        case 'A':
+            if (count != 4 && count != 5)
+                return false;
+            if (!parse_weight(fields[2], false, &course_weight))
+                *status = CGPA_ERR_WEIGHT;
+            else if (count == 5 && term_field(fields[4], &term) != CGPA_OK)
+                *status = CGPA_ERR_TERM;
+            else if (course_exists(transcript, fields[1]))
+                *status = CGPA_ERR_EXISTS;
+            else
+                *status = cgpa_transcript_add_term(transcript, fields[1], course_weight,
+                                                   grade_field(fields[3]), term);
+            return true;
+
+        case 'E':
+            if (count != 5)
+                return false;
+            if (keep_field(fields[2]) &&
+                course_key_from_code(fields[2]) != course_key_from_code(fields[1]) &&
+                course_exists(transcript, fields[2]))
+                *status = CGPA_ERR_EXISTS;
+            else if (!parse_weight(fields[3], true, &course_weight))
+                *status = CGPA_ERR_WEIGHT;
+            else
+                *status = cgpa_transcript_update(transcript, fields[1], keep_field(fields[2]),
+                                                 course_weight,
+                                                 keep_field(grade_field(fields[4])));
+            return true;
+
+        case 'D':
+            if (count != 2)
+                return false;
+            *status = cgpa_transcript_remove(transcript, fields[1]);
+            return true;
+
+        case 'Q': {
+            cgpa_course_t course;
+
+            if (count != 2)
+                return false;
+
+            *status = cgpa_transcript_query(transcript, fields[1], &course);
+            if (*status == CGPA_OK) {
+                char term_buf[TERM_BUF_LEN];
+
+                term_to_string(course.term, term_buf);
+                snprintf(reply, SERVER_REPLY_MAX, "OK %s %.2f %s %.2f%s%s", course.course_code,
+                         course.course_weight, grade_to_string(course.grade),
+                         course.credits_earned, term_buf[0] ? " " : "", term_buf);
+            }
+            return true;
+        }
+
+        case 'T':
+            if (count != 1)
+                return false;
+            totals_reply(reply, cgpa_transcript_count(transcript),
+                         cgpa_transcript_totals(transcript));
+            *status = CGPA_OK;
+            return true;
+
+        case 'G':
+        case 'C': {
+            if (count != 2)
+                return false;
+
+            *status = term_field(fields[1], &term);
+            if (*status != CGPA_OK)
+                return true;
+
+            cgpa_totals_t totals =
+                op[0] == 'G' ? cgpa_transcript_term_totals(transcript, term, &covered)
+                             : cgpa_transcript_cumulative_totals(transcript, term, &covered);
+            totals_reply(reply, covered, totals);
+            return true;
+        }
+
+        case 'S': {
+            course_key_t first, last;
+
+            if (count != 2)
+                return false;
+
+            if (!course_key_range_from_string(fields[1], &first, &last)) {
+                *status = CGPA_ERR_CODE;
+                return true;
+            }
+
+            cgpa_totals_t totals = cgpa_transcript_range_totals(transcript, first, last, &covered);
+            totals_reply(reply, covered, totals);
+            *status = CGPA_OK;
+            return true;
+        }
+
+        default:
+            return false;
+    }
+}
+
+// Answer one request line; false if the reply could not be queued
+static bool client_request(cgpa_transcript_t *transcript, client_t *client, char *line) {
+    INSTR_START(start);
+    char *fields[SERVER_MAX_FIELDS + 1];
+    char reply[SERVER_REPLY_MAX] = "OK";
+    size_t count = 0;
+    char *save;
+
+    for (char *field = strtok_r(line, " ", &save); field && count <= SERVER_MAX_FIELDS;
+         field = strtok_r(NULL, " ", &save))
+        fields[count++] = field;
+
+    const char *answer = "ERR request";
+    cgpa_status_t status;
+
+    if (count > 0 && count <= SERVER_MAX_FIELDS &&
+        run_request(transcript, fields, count, reply, &status))
+        answer = status == CGPA_OK ? reply : status_reason(status);
+
+    bool ok = client_reply(client, answer);
+    INSTR_END(INSTR_REQUEST, start);
+
+    return ok;
+}
+
+static size_t client_pending(const client_t *client) {
+    return client->out_len - client->out_sent;
+}
+
+static bool client_has_line(const client_t *client) {
+    return memchr(client->in, '\n', client->in_len) != NULL;
+}
+
+// Answer complete lines until the reply queue is full
+static bool client_answer(cgpa_transcript_t *transcript, client_t *client,
+                          server_stats_t *stats) {
+    size_t start = 0;
+
+    while (client_pending(client) < SERVER_OUT_HIGH) {
+        char *line = client->in + start;
+        char *newline = memchr(line, '\n', client->in_len - start);
+
+        if (!newline)
+            break;
+
+        *newline = '\0';
+        if (newline > line && newline[-1] == '\r')
+            newline[-1] = '\0';
+
+        if (!client_request(transcript, client, line))
+            return false;
+
+        stats->requests++;
+        start = (size_t)(newline - client->in) + 1;
+    }
+
+    memmove(client->in, client->in + start, client->in_len - start);
+    client->in_len -= start;
+
+    if (client->in_len == sizeof client->in && !client_has_line(client)) {
+        client->in_len = 0;
+        client->closing = true;
+        return client_reply(client, "ERR too-long");
+    }
+
+    return true;
+}
+
+// Send queued replies until the socket would block; false on a dead peer
+static bool client_flush(client_t *client) {
+    while (client_pending(client) > 0) {
+        ssize_t n = send(client->fd, client->out + client->out_sent, client_pending(client),
+                         MSG_NOSIGNAL);
+
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0)
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+
+        client->out_sent += (size_t)n;
+    }
+
+    client->out_len = client->out_sent = 0;
+    return true;
+}
+
+// Answer and send until the client blocks or has nothing left
+static bool client_service(cgpa_transcript_t *transcript, client_t *client,
+                           server_stats_t *stats) {
+    for (;;) {
+        if (!client_answer(transcript, client, stats) || !client_flush(client))
+            return false;
+        if (client_pending(client) > 0 || !client_has_line(client))
+            return true;
+    }
+}
+
+static bool client_read(cgpa_transcript_t *transcript, client_t *client, server_stats_t *stats) {
+    ssize_t n = recv(client->fd, client->in + client->in_len,
+                     sizeof client->in - client->in_len, 0);
+
+    if (n < 0)
+        return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+    if (n == 0)
+        client->closing = true;  // Answer what is buffered, then close
+    else
+        client->in_len += (size_t)n;
+
+    return client_service(transcript, client, stats);
+}
+
+// Read while the reply queue has room; write while it is not empty
+static bool client_watch(server_t *server, client_t *client) {
+    uint32_t events = 0;
+
+    if (!client->closing && client_pending(client) < SERVER_OUT_HIGH)
+        events |= EPOLLIN;
+    if (client_pending(client) > 0)
+        events |= EPOLLOUT;
+
+    if (events == client->events)
+        return true;
+
+    struct epoll_event ev = {.events = events, .data.ptr = client};
+    client->events = events;
+
+    return epoll_ctl(server->epoll_fd, EPOLL_CTL_MOD, client->fd, &ev) == 0;
+}
+
+static void client_close(server_t *server, client_t *client) {
+    epoll_ctl(server->epoll_fd, EPOLL_CTL_DEL, client->fd, NULL);
+    close(client->fd);
+
+    if (client->prev)
+        client->prev->next = client->next;
+    else
+        server->clients = client->next;
+    if (client->next)
+        client->next->prev = client->prev;
+
+    free(client->out);
+    free(client);
+}
+
+// Accept every waiting connection
+static void server_accept(server_t *server, server_stats_t *stats) {
+    for (;;) {
+        int fd = accept(server->listen_fd, NULL, NULL);
+
+        if (fd < 0 && errno == EINTR)
+            continue;
+        if (fd < 0)
+            return;  // Drained, or out of descriptors until a client leaves
+
+        int one = 1;
+        client_t *client = calloc(1, sizeof *client);
+
+        if (!client || !set_nonblocking(fd) ||
+            (server->tcp && setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof one) != 0)) {
+            free(client);
+            close(fd);
+            continue;
+        }
+
+        struct epoll_event ev = {.events = EPOLLIN, .data.ptr = client};
+        client->fd = fd;
+        client->events = EPOLLIN;
+
+        if (epoll_ctl(server->epoll_fd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+            free(client);
+            close(fd);
+            continue;
+        }
+
+        client->next = server->clients;
+        if (server->clients)
+            server->clients->prev = client;
+        server->clients = client;
+
+        stats->connections++;
+    }
+}
+
+static void client_event(server_t *server, cgpa_transcript_t *transcript, client_t *client,
+                         uint32_t events, server_stats_t *stats) {
+    bool alive = !(events & EPOLLERR);
+
+    if (alive && (events & EPOLLIN))
+        alive = client_read(transcript, client, stats);
+    else if (alive && (events & EPOLLOUT))
+        alive = client_service(transcript, client, stats);
+    else if (events & EPOLLHUP)
+        alive = false;
+
+    if (alive && client->closing && client_pending(client) == 0)
+        alive = false;
+
+    if (!alive || !client_watch(server, client))
+        client_close(server, client);
+}
+
+// Listener and signal entries point at their fd field; clients at their struct
+static bool server_watch(server_t *server, int *fd) {
+    struct epoll_event ev = {.events = EPOLLIN, .data.ptr = fd};
+
+    return epoll_ctl(server->epoll_fd, EPOLL_CTL_ADD, *fd, &ev) == 0;
+}
+
+static server_status_t server_loop(server_t *server, cgpa_transcript_t *transcript,
+                                   server_stats_t *stats) {
+    struct epoll_event events[SERVER_EVENTS];
+
+    for (;;) {
+        int n = epoll_wait(server->epoll_fd, events, SERVER_EVENTS, -1);
+
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0)
+            return SERVER_ERR_IO;
+
+        for (int i = 0; i < n; i++) {
+            if (events[i].data.ptr == &server->signal_fd) {
+                struct signalfd_siginfo info;
+
+                // Consume the signal, or it is delivered once the mask is restored
+                if (read(server->signal_fd, &info, sizeof info) != sizeof info)
+                    return SERVER_ERR_IO;
+                return SERVER_OK;
+            } else if (events[i].data.ptr == &server->listen_fd) {
+                server_accept(server, stats);
+            } else {
+                client_event(server, transcript, events[i].data.ptr, events[i].events, stats);
+            }
+        }
+    }
+}
+
+server_status_t server_run(cgpa_transcript_t *transcript, const char *address,
+                           server_stats_t *stats) {
+    server_t server = {.epoll_fd = -1, .listen_fd = -1, .signal_fd = -1};
+    server_stats_t count = {0};
+    server_status_t status = SERVER_OK;
+    sigset_t mask, old_mask;
+
+    if (!stats)
+        stats = &count;
+    *stats = (server_stats_t){0};
+
+    // SIGINT / SIGTERM arrive through the event loop instead of interrupting it
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGINT);
+    sigaddset(&mask, SIGTERM);
+    if (sigprocmask(SIG_BLOCK, &mask, &old_mask) != 0)
+        return SERVER_ERR_IO;
+
+    if (!server_listen(&server, address))
+        status = SERVER_ERR_LISTEN;
+    else if ((server.signal_fd = signalfd(-1, &mask, SFD_CLOEXEC)) < 0 ||
+             (server.epoll_fd = epoll_create1(EPOLL_CLOEXEC)) < 0 ||
+             !server_watch(&server, &server.signal_fd) ||
+             !server_watch(&server, &server.listen_fd))
+        status = SERVER_ERR_IO;
+    else
+        status = server_loop(&server, transcript, stats);
+
+    while (server.clients)
+        client_close(&server, server.clients);
+
+    if (server.listen_fd >= 0)
+        close(server.listen_fd);
+    if (server.unix_path)
+        unlink(server.unix_path);
+    if (server.signal_fd >= 0)
+        close(server.signal_fd);
+    if (server.epoll_fd >= 0)
+        close(server.epoll_fd);
+
+    sigprocmask(SIG_SETMASK, &old_mask, NULL);
+    return status;
+}
@@ -0,0 +1,70 @@
+/***********************************
+ * server.h
+ *
+ * CGPA Calculator - query daemon
+ *
+ * Defines:
+ * - the line request protocol
+ * - server status codes and the serve entry point
+ *
+ * Author: Arul Rao (Vidonicle)
+ * License: MIT
+ ***********************************/
+
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <stddef.h>
+
+#include "cgpa.h"
+
+#define SERVER_LINE_MAX 128           // Longest request, '\n' included
+#define SERVER_OUT_HIGH (256u << 10)  // Stop reading a client with this much unsent
+#define SERVER_BACKLOG 128
+
+/*
+ * One request per line, fields separated by spaces:
+ *   A CODE WEIGHT GRADE [TERM]    add a course not already in, optionally with its term
+ *   E CODE NEWCODE WEIGHT GRADE   edit a course; '-' keeps a field
+ *   D CODE                        delete a course
+ *   Q CODE                        -> OK CODE WEIGHT GRADE CREDITS [TERM]
+ *   T                             -> OK COURSES EARNED COMPLETED CGPA
+ *   G TERM                        -> OK COURSES EARNED COMPLETED GPA (that term)
+ *   C TERM                        -> OK COURSES EARNED COMPLETED CGPA (through it)
+ *   S RANGE                       -> OK COURSES EARNED COMPLETED GPA (those codes)
+ *
+ * Terms are written W2025, S2025 or F2025. Ranges are a code prefix
+ * (SYSC, SYSC2) or two joined by '-' (SYSC2000-SYSC3999).
+ *
+ * Every request gets one line back, in order: "OK[ fields]" or
+ * "ERR reason" (code, weight, grade, term, not-found, exists, oom,
+ * request, too-long). As in the menu, a code is in the transcript at most
+ * once: A for a code already in, or E renaming onto one, answers
+ * "ERR exists". A too-long request closes the connection after its reply.
+ */
+
+typedef enum {
+    SERVER_OK = 0,
+    SERVER_ERR_LISTEN,  // Could not bind or listen on the address
+    SERVER_ERR_IO,      // epoll or signal setup failed
+    SERVER_ERR_OOM
+} server_status_t;
+
+typedef struct {
+    size_t connections;  // Clients accepted
+    size_t requests;     // Lines answered
+} server_stats_t;
+
+/*
+ * Serve transcript on address until SIGINT or SIGTERM. An address of
+ * digits only is a TCP port on 127.0.0.1; anything else is a Unix socket
+ * path, replaced if it exists. stats may be NULL.
+ *
+ * The protocol has no student key: every client reads and edits this one
+ * transcript. A portal serving many students runs one server per
+ * transcript, each on its own address.
+ */
+server_status_t server_run(cgpa_transcript_t *transcript, const char *address,
+                           server_stats_t *stats);
+
+#endif /* SERVER_H */
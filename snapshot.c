@@ -0,0 +1,261 @@
+/***********************************
+ * snapshot.c
+ *
+ * CGPA Calculator - binary transcript snapshots
+ *
+ * Handles:
+ * - encoding the course list as fixed-size records
+ * - atomic snapshot writes
+ * - mapped snapshot reads straight into the course list
+ *
+ * Author: Arul Rao (Vidonicle)
+ * License: MIT
+ ***********************************/
+#define _POSIX_C_SOURCE 200809L
+
+#include "snapshot.h"
+
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "cgpa.h"
+#include "courselist.h"
+#include "instrument.h"
+#include "loader.h"
+#include "scale.h"
+#include "writer.h"
+
+#define WEIGHT_UNITS 4.0f  // Weights are stored in quarter credits
+
+void store_le(unsigned char *p, uint64_t value, size_t len) {
+    for (size_t i = 0; i < len; i++)
+        p[i] = (unsigned char)(value >> (8 * i));
+}
+
+uint64_t load_le(const unsigned char *p, size_t len) {
+    uint64_t value = 0;
+
+    for (size_t i = len; i-- > 0;)
+        value = (value << 8) | p[i];
+
+    return value;
+}
+
+// Key fields must be in range: letters A-Z, number 0-9999
+static bool key_valid(course_key_t key) {
+    if (key >> COURSE_KEY_BITS || COURSE_KEY_NUMBER(key) > 9999)
+        return false;
+
+    course_key_t subject = COURSE_KEY_SUBJECT(key);
+    for (size_t i = 0; i < 4; i++, subject >>= COURSE_KEY_LETTER_BITS) {
+        if ((subject & ((1u << COURSE_KEY_LETTER_BITS) - 1)) > 25)
+            return false;
+    }
+
+    return true;
+}
+
+static snapshot_status_t write_snapshot(const courselist_t *courses, int fd,
+                                        uint64_t journal_seq) {
+    char buf[WRITER_STACK_BUF_LEN];
+    writer_t out;
+    unsigned char header[SNAPSHOT_HEADER_LEN] = {0};
+
+    writer_init(&out, fd, buf, sizeof buf);
+
+    memcpy(header, SNAPSHOT_MAGIC, 8);
+    store_le(header + 8, SNAPSHOT_VERSION, 4);
+    store_le(header + 12, SNAPSHOT_RECORD_LEN, 4);
+    store_le(header + 16, courses->count, 8);
+    store_le(header + 24, journal_seq, 8);
+    writer_write(&out, (const char *)header, sizeof header);
+
+    for (const coursenode_t *curr = courses->head; curr; curr = curr->next) {
+        float units = curr->course_weight * WEIGHT_UNITS;
+
+        if (!(units >= 0.0f && units <= (float)UINT16_MAX && units == (float)(uint16_t)units))
+            return SNAPSHOT_ERR_WEIGHT;
+
+        unsigned char record[SNAPSHOT_RECORD_LEN] = {0};
+        store_le(record, curr->key, 8);
+        store_le(record + 8, (uint16_t)units, 2);
+        record[10] = curr->grade;
+        store_le(record + 12, curr->term, 2);
+        writer_write(&out, (const char *)record, sizeof record);
+    }
+
+    if (!writer_flush(&out) || fsync(fd) != 0)
+        return SNAPSHOT_ERR_IO;
+
+    return SNAPSHOT_OK;
+}
+
+// Flush the directory entry for path, so a rename or create survives a crash
+bool sync_parent_dir(const char *path) {
+    const char *slash = strrchr(path, '/');
+    size_t len = !slash ? 0 : slash == path ? 1 : (size_t)(slash - path);  // "/x" lives in "/"
+    char *dir = malloc(len + sizeof ".");
+    if (!dir)
+        return false;
+
+    if (len == 0) {
+        memcpy(dir, ".", sizeof ".");
+    } else {
+        memcpy(dir, path, len);
+        dir[len] = '\0';
+    }
+
+    int fd = open(dir, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    free(dir);
+    if (fd < 0)
+        return false;
+
+    bool ok = fsync(fd) == 0;
+    return close(fd) == 0 && ok;
+}
+
+// Write every course to path via a temporary file and rename
+snapshot_status_t snapshot_save(const courselist_t *courses, const char *path,
+                                uint64_t journal_seq) {
+    INSTR_START(start);
+    size_t len = strlen(path);
+    char *tmp_path = malloc(len + sizeof ".tmp");
+    if (!tmp_path)
+        return SNAPSHOT_ERR_OOM;
+
+    memcpy(tmp_path, path, len);
+    memcpy(tmp_path + len, ".tmp", sizeof ".tmp");
+
+    int fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        free(tmp_path);
+        return SNAPSHOT_ERR_IO;
+    }
+
+    snapshot_status_t status = write_snapshot(courses, fd, journal_seq);
+
+    if (close(fd) != 0 && status == SNAPSHOT_OK)
+        status = SNAPSHOT_ERR_IO;
+    if (status == SNAPSHOT_OK && (rename(tmp_path, path) != 0 || !sync_parent_dir(path)))
+        status = SNAPSHOT_ERR_IO;
+    if (status != SNAPSHOT_OK)
+        unlink(tmp_path);
+
+    free(tmp_path);
+    INSTR_END(INSTR_SNAPSHOT_SAVE, start);
+
+    return status;
+}
+
+// Decode and check the header; returns the record count or SIZE_MAX
+static size_t read_header(const unsigned char *data, size_t len, uint32_t *version) {
+    if (len < SNAPSHOT_HEADER_LEN || memcmp(data, SNAPSHOT_MAGIC, 8) != 0)
+        return SIZE_MAX;
+
+    *version = (uint32_t)load_le(data + 8, 4);
+    if (*version < SNAPSHOT_VERSION_MIN || *version > SNAPSHOT_VERSION ||
+        load_le(data + 12, 4) != SNAPSHOT_RECORD_LEN)
+        return SIZE_MAX;
+
+    uint64_t count = load_le(data + 16, 8);
+    if (count != (len - SNAPSHOT_HEADER_LEN) / SNAPSHOT_RECORD_LEN ||
+        (len - SNAPSHOT_HEADER_LEN) % SNAPSHOT_RECORD_LEN != 0)
+        return SIZE_MAX;
+
+    return (size_t)count;
+}
+
+/*
+ * Records are stored in list order. add_courses_sorted puts later records
+ * of the same code first, so each group of equal keys is decoded back to
+ * front to come out in the order it was saved. Weights and grades must
+ * pass scale's checks, as they do when typed in or read from text.
+ */
+static snapshot_status_t decode_records(const unsigned char *data, size_t count,
+                                        uint32_t version, const grading_scale_t *scale,
+                                        course_record_t *records) {
+    for (size_t i = 0; i < count;) {
+        course_key_t key = load_le(data + i * SNAPSHOT_RECORD_LEN, 8);
+        size_t group_end = i + 1;
+
+        while (group_end < count && load_le(data + group_end * SNAPSHOT_RECORD_LEN, 8) == key)
+            group_end++;
+
+        if (!key_valid(key) || (i > 0 && key < records[i - 1].key))
+            return SNAPSHOT_ERR_FORMAT;
+
+        for (size_t j = i; j < group_end; j++) {
+            const unsigned char *rec = data + (i + group_end - 1 - j) * SNAPSHOT_RECORD_LEN;
+
+            term_t term = version >= 2 ? (term_t)load_le(rec + 12, 2) : TERM_NONE;
+            uint64_t units = load_le(rec + 8, 2);
+            float course_weight = (float)units / WEIGHT_UNITS;
+
+            if (units == 0 || !scale_accepts_weight(scale, course_weight) ||
+                !scale_accepts_grade(scale, (grade_t)rec[10]) || term > TERM_COUNT)
+                return SNAPSHOT_ERR_FORMAT;
+
+            records[j].key = key;
+            records[j].course_weight = course_weight;
+            records[j].grade = rec[10];
+            records[j].term = term;
+        }
+
+        i = group_end;
+    }
+
+    return SNAPSHOT_OK;
+}
+
+// Add a snapshot's courses to the list, resolving repeated codes by policy
+snapshot_status_t snapshot_load(courselist_t *courses, FILE *fptr, load_duplicates_t duplicates,
+                                load_stats_t *stats, uint64_t *journal_seq) {
+    INSTR_START(start);
+    load_stats_t local = {0};
+    if (!stats)
+        stats = &local;
+    *stats = (load_stats_t){0};
+
+    file_view_t view;
+
+    if (!file_view_open(&view, fptr))
+        return SNAPSHOT_ERR_IO;
+
+    const unsigned char *data = (const unsigned char *)view.data;
+    uint32_t version = 0;
+    size_t count = read_header(data, view.len, &version);
+    snapshot_status_t status = SNAPSHOT_OK;
+    course_record_t *records = NULL;
+
+    if (count == SIZE_MAX)
+        status = SNAPSHOT_ERR_FORMAT;
+    else if (!(records = malloc((count ? count : 1) * sizeof(course_record_t))))
+        status = SNAPSHOT_ERR_OOM;
+    else
+        status = decode_records(data + SNAPSHOT_HEADER_LEN, count, version, courses->scale,
+                                records);
+
+    if (status == SNAPSHOT_OK) {
+        size_t kept = load_resolve_records(courses, records, count, duplicates,
+                                           &stats->duplicates);
+
+        if (!add_courses_sorted(courses, records, kept))
+            status = SNAPSHOT_ERR_OOM;
+        stats->records = kept;
+        stats->bytes = view.len;
+    }
+    if (status == SNAPSHOT_OK && journal_seq)
+        *journal_seq = load_le(data + 24, 8);
+
+    free(records);
+    file_view_close(&view);
+    INSTR_END(INSTR_SNAPSHOT_LOAD, start);
+
+    return status;
+}
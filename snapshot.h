@@ -0,0 +1,78 @@
+/***********************************
+ * snapshot.h
+ *
+ * CGPA Calculator - binary transcript snapshots
+ *
+ * Defines:
+ * - the versioned fixed-record snapshot format
+ * - snapshot save / load status codes
+ *
+ * Author: Arul Rao (Vidonicle)
+ * License: MIT
+ ***********************************/
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "courselist.h"
+#include "loader.h"
+
+#define SNAPSHOT_EXT ".cgpa"  // File extension for snapshots
+#define SNAPSHOT_MAGIC "CGPASNAP"
+#define SNAPSHOT_VERSION 2
+#define SNAPSHOT_VERSION_MIN 1  // Oldest version still read
+
+/*
+ * Layout (all integers little-endian):
+ *   header, 32 bytes: magic[8], version u32, record size u32,
+ *                     record count u64, journal sequence u64
+ *   records, 16 bytes each, in list order:
+ *                     course key u64, weight in quarter units u16,
+ *                     grade_t u8, flags u8, term_t u16, reserved u16
+ *
+ * Version 1 records have no term (bytes 12-15 reserved); they load with
+ * TERM_NONE.
+ */
+#define SNAPSHOT_HEADER_LEN 32
+#define SNAPSHOT_RECORD_LEN 16
+
+typedef enum {
+    SNAPSHOT_OK = 0,
+    SNAPSHOT_ERR_IO,      // Could not read or write the file
+    SNAPSHOT_ERR_FORMAT,  // Bad magic, version, size or record, or off the scale
+    SNAPSHOT_ERR_WEIGHT,  // A weight is not a multiple of 0.25
+    SNAPSHOT_ERR_OOM
+} snapshot_status_t;
+
+/*
+ * Write every course to path. The file is written beside path, synced,
+ * renamed into place and the directory synced, so a failed save or a
+ * crash never leaves a truncated snapshot.
+ * journal_seq is the last journal entry the snapshot covers (0 if none).
+ */
+snapshot_status_t snapshot_save(const courselist_t *courses, const char *path,
+                                uint64_t journal_seq);
+
+/*
+ * Add every course in a snapshot to the list (memory-mapped, no parsing).
+ * Codes repeated in the snapshot or already in the list are resolved by
+ * duplicates, as for a text load. stats (records, duplicates and bytes)
+ * and journal_seq may be NULL.
+ */
+snapshot_status_t snapshot_load(courselist_t *courses, FILE *fptr, load_duplicates_t duplicates,
+                                load_stats_t *stats, uint64_t *journal_seq);
+
+// fsync the directory holding path; shared with the journal
+bool sync_parent_dir(const char *path);
+
+// Little-endian field helpers, shared with the journal format
+void store_le(unsigned char *p, uint64_t value, size_t len);
+
+uint64_t load_le(const unsigned char *p, size_t len);
+
+#endif /* SNAPSHOT_H */
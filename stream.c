@@ -0,0 +1,254 @@
+/***********************************
+ * stream.c
+ *
+ * CGPA Calculator - streaming totals
+ *
+ * Handles:
+ * - chunked reads with lines carried across chunk boundaries
+ * - batched accumulation through the aggregation kernel
+ * - duplicate detection over the packed course-code space
+ *
+ * Author: Arul Rao (Vidonicle)
+ * License: MIT
+ ***********************************/
+#define _POSIX_C_SOURCE 200809L
+
+#include "stream.h"
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "aggregate.h"
+#include "cgpa.h"
+#include "courselist.h"
+#include "instrument.h"
+#include "loader.h"
+#include "scale.h"
+
+#define STREAM_BATCH_LEN 256  // Rows per kernel call
+#define SET_MIN_SLOTS 16             // First subject table; doubles at half full
+#define PAGE_BYTES ((10000 + 7) / 8)  // One bit per course number 0-9999
+
+// Seen course numbers of one subject
+typedef struct {
+    uint32_t subject;  // COURSE_KEY_SUBJECT + 1; 0 = empty slot
+    uint8_t *page;
+} subject_page_t;
+
+/*
+ * Seen course codes. An open-addressed table maps each subject that
+ * appears to a page of bits, so a transcript touches a few KiB however
+ * long the input is.
+ */
+typedef struct {
+    subject_page_t *slots;
+    size_t capacity;  // Power of two, or 0 before the first code
+    size_t used;
+} course_set_t;
+
+// Slot of a subject, or the empty slot where it would go
+static subject_page_t *course_set_slot(const course_set_t *set, uint32_t subject) {
+    size_t mask = set->capacity - 1;
+    size_t i = (size_t)course_key_hash((course_key_t)subject << COURSE_KEY_NUMBER_BITS) & mask;
+
+    while (set->slots[i].subject != 0 && set->slots[i].subject != subject + 1)
+        i = (i + 1) & mask;
+
+    return &set->slots[i];
+}
+
+// Double the subject table, rehashing every subject into it
+static bool course_set_grow(course_set_t *set) {
+    course_set_t grown = {
+        .capacity = set->capacity ? set->capacity * 2 : SET_MIN_SLOTS,
+        .used = set->used,
+    };
+
+    grown.slots = calloc(grown.capacity, sizeof *grown.slots);
+    if (!grown.slots)
+        return false;
+
+    for (size_t i = 0; i < set->capacity; i++) {
+        if (set->slots[i].subject != 0)
+            *course_set_slot(&grown, set->slots[i].subject - 1) = set->slots[i];
+    }
+
+    free(set->slots);
+    *set = grown;
+    return true;
+}
+
+// Mark key as seen; *inserted is false if it already was
+static bool course_set_insert(course_set_t *set, course_key_t key, bool *inserted) {
+    uint32_t subject = (uint32_t)COURSE_KEY_SUBJECT(key);
+    subject_page_t *slot = set->capacity ? course_set_slot(set, subject) : NULL;
+
+    if (!slot || slot->subject == 0) {
+        if ((set->used + 1) * 2 > set->capacity && !course_set_grow(set))
+            return false;
+
+        slot = course_set_slot(set, subject);
+        if (!(slot->page = calloc(1, PAGE_BYTES)))
+            return false;
+
+        slot->subject = subject + 1;
+        set->used++;
+    }
+
+    unsigned number = COURSE_KEY_NUMBER(key);
+    uint8_t bit = (uint8_t)(1u << (number & 7));
+
+    *inserted = !(slot->page[number >> 3] & bit);
+    slot->page[number >> 3] |= bit;
+
+    return true;
+}
+
+static void course_set_free(course_set_t *set) {
+    for (size_t i = 0; i < set->capacity; i++)
+        free(set->slots[i].page);
+
+    free(set->slots);
+    *set = (course_set_t){0};
+}
+
+typedef struct {
+    cgpa_totals_t *totals;
+    stream_stats_t *stats;
+    const float *scale;              // Points by grade_t
+    const grading_scale_t *grading;  // Accepted weights
+    course_set_t seen;
+    bool unique;
+    float weight[STREAM_BATCH_LEN];
+    float points[STREAM_BATCH_LEN];
+    size_t batched;
+} stream_t;
+
+static bool stream_line(stream_t *s, const char *p, const char *end) {
+    course_record_t record;
+
+    if (!scan_course_line(p, end, s->grading, &record, &s->stats->load))
+        return true;
+
+    if (s->unique) {
+        bool inserted;
+
+        if (!course_set_insert(&s->seen, record.key, &inserted))
+            return false;
+        if (!inserted) {
+            s->stats->duplicates++;
+            return true;
+        }
+    }
+
+    s->weight[s->batched] = record.course_weight;
+    s->points[s->batched] = s->scale[record.grade];
+    s->stats->load.records++;
+
+    if (++s->batched == STREAM_BATCH_LEN) {
+        cgpa_accumulate(s->totals, s->weight, s->points, s->batched);
+        s->batched = 0;
+    }
+
+    return true;
+}
+
+/*
+ * Each read fills the buffer after any partial line left by the last
+ * one. A line that still has no end when the buffer is full cannot be a
+ * course, so it is counted as skipped and dropped up to its newline.
+ */
+static bool stream_fd(stream_t *s, int fd) {
+    char buf[STREAM_BUF_LEN];
+    size_t carry = 0;
+    bool discarding = false;
+
+    while (true) {
+        ssize_t n = read(fd, buf + carry, sizeof buf - carry);
+
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0)
+            return false;
+
+        s->stats->load.bytes += (size_t)n;
+
+        if (n == 0) {
+            if (carry > 0 && !discarding)
+                return stream_line(s, buf, buf + carry);
+            return true;
+        }
+
+        const char *p = buf;
+        const char *end = buf + carry + (size_t)n;
+        const char *eol;
+
+        if (discarding) {
+            if (!(eol = memchr(p, '\n', (size_t)(end - p))))
+                continue;
+
+            discarding = false;
+            p = eol + 1;
+        }
+
+        while ((eol = memchr(p, '\n', (size_t)(end - p)))) {
+            if (!stream_line(s, p, eol))
+                return false;
+            p = eol + 1;
+        }
+
+        carry = (size_t)(end - p);
+
+        if (carry == sizeof buf) {
+            s->stats->load.lines++;
+            s->stats->load.skipped++;
+            discarding = true;
+            carry = 0;
+        } else {
+            memmove(buf, p, carry);
+        }
+    }
+}
+
+bool stream_totals(int fd, const grading_scale_t *scale, bool unique, cgpa_totals_t *totals,
+                   stream_stats_t *stats) {
+    stream_stats_t local;
+    stream_t s;
+
+    if (!stats)
+        stats = &local;
+    memset(stats, 0, sizeof *stats);
+
+    totals->credits_earned = 0.0;
+    totals->credits_completed = 0.0;
+
+    s.totals = totals;
+    s.stats = stats;
+    s.scale = scale_points(scale);
+    s.grading = scale;
+    s.seen = (course_set_t){0};
+    s.unique = unique;
+    s.batched = 0;
+
+    INSTR_START(instr_start);
+    double start = now_seconds();
+    bool ok = stream_fd(&s, fd);
+
+    cgpa_accumulate(totals, s.weight, s.points, s.batched);
+    cgpa_finalize(totals);
+    course_set_free(&s.seen);
+
+    stats->load.seconds = now_seconds() - start;
+    INSTR_END(INSTR_STREAM, instr_start);
+    INSTR_COUNT(INSTR_LINES, stats->load.lines);
+    INSTR_COUNT(INSTR_SKIPPED, stats->load.skipped);
+    INSTR_COUNT(INSTR_BYTES, stats->load.bytes);
+    INSTR_COUNT(INSTR_RECORDS, stats->load.records);
+
+    return ok;
+}
@@ -0,0 +1,44 @@
+/***********************************
+ * stream.h
+ *
+ * CGPA Calculator - streaming totals
+ *
+ * Defines:
+ * - the streaming statistics
+ * - the fixed-memory totals pass over a course file
+ *
+ * Author: Arul Rao (Vidonicle)
+ * License: MIT
+ ***********************************/
+
+#ifndef STREAM_H
+#define STREAM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "cgpa.h"
+#include "loader.h"
+
+#define STREAM_BUF_LEN 65536  // Read buffer; longer lines are skipped
+
+typedef struct {
+    load_stats_t load;  // Bytes, lines, records counted and lines skipped
+    size_t duplicates;  // Records dropped as repeats of an earlier code
+} stream_stats_t;
+
+/*
+ * Read course lines from fd until end of input and accumulate their
+ * totals without building a course list. Lines use the same format as
+ * load_from_file and are scored on scale (NULL = built-in); lines with
+ * a weight or grade the scale does not accept are skipped. Memory use is
+ * fixed, except that with unique set the first record of each code is
+ * kept and later ones are dropped, tracked in a bitset with one page per
+ * subject seen, found through a small table that grows with the subjects.
+ *
+ * stats may be NULL. Returns false on read or allocation failure.
+ */
+bool stream_totals(int fd, const grading_scale_t *scale, bool unique, cgpa_totals_t *totals,
+                   stream_stats_t *stats);
+
+#endif /* STREAM_H */
@@ -0,0 +1,189 @@
+/***********************************
+ * transcript.c
+ *
+ * CGPA Calculator - library API over the course list
+ *
+ * Handles:
+ * - creating and destroying transcript handles
+ * - validated add / remove / update / query by course code
+ * - per-term and cumulative totals
+ * - code range totals
+ * - copying courses out for iteration and lookups
+ *
+ * Author: Arul Rao (Vidonicle)
+ * License: MIT
+ ***********************************/
+
+#include "cgpa.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "courselist.h"
+#include "scale.h"
+
+// Copy a node out so callers never hold pointers into the list
+static void course_copy(const coursenode_t *node, cgpa_course_t *course) {
+    course_key_to_code(node->key, course->course_code);
+    course->key = node->key;
+    course->course_weight = node->course_weight;
+    course->credits_earned = node->credits_earned;
+    course->grade = (grade_t)node->grade;
+    course->term = node->term;
+}
+
+// Parse a letter grade the transcript's scale defines
+static cgpa_status_t parse_grade(const cgpa_transcript_t *transcript, const char *letter_grade,
+                                 grade_t *grade) {
+    *grade = grade_from_string(letter_grade);
+
+    if (*grade == GRADE_INVALID || !scale_accepts_grade(transcript->scale, *grade))
+        return CGPA_ERR_GRADE;
+
+    return CGPA_OK;
+}
+
+cgpa_transcript_t *cgpa_transcript_create(const grading_scale_t *scale) {
+    cgpa_transcript_t *transcript = calloc(1, sizeof *transcript);
+
+    if (transcript)
+        transcript->scale = scale;
+
+    return transcript;
+}
+
+void cgpa_transcript_destroy(cgpa_transcript_t *transcript) {
+    if (!transcript)
+        return;
+
+    deconstruct(transcript);
+    free(transcript);
+}
+
+cgpa_status_t cgpa_transcript_add(cgpa_transcript_t *transcript, const char *course_code,
+                                  float course_weight, const char *letter_grade) {
+    return cgpa_transcript_add_term(transcript, course_code, course_weight, letter_grade,
+                                    TERM_NONE);
+}
+
+cgpa_status_t cgpa_transcript_add_term(cgpa_transcript_t *transcript, const char *course_code,
+                                       float course_weight, const char *letter_grade,
+                                       term_t term) {
+    course_record_t record = {.key = course_key_from_code(course_code),
+                              .course_weight = course_weight,
+                              .term = term};
+    grade_t grade;
+
+    if (record.key == COURSE_KEY_INVALID)
+        return CGPA_ERR_CODE;
+    if (!scale_accepts_weight(transcript->scale, course_weight))
+        return CGPA_ERR_WEIGHT;
+    if (parse_grade(transcript, letter_grade, &grade) != CGPA_OK)
+        return CGPA_ERR_GRADE;
+    if (term > TERM_COUNT)
+        return CGPA_ERR_TERM;
+
+    record.grade = (uint8_t)grade;
+    return add_course_record(transcript, &record) ? CGPA_OK : CGPA_ERR_OOM;
+}
+
+cgpa_status_t cgpa_transcript_remove(cgpa_transcript_t *transcript, const char *course_code) {
+    course_key_t key = course_key_from_code(course_code);
+
+    if (key == COURSE_KEY_INVALID)
+        return CGPA_ERR_CODE;
+    if (!fetch_node_key(transcript, key))
+        return CGPA_ERR_NOT_FOUND;
+
+    delete_course_key(transcript, key);
+    return CGPA_OK;
+}
+
+// Every argument is checked before the course is touched
+cgpa_status_t cgpa_transcript_update(cgpa_transcript_t *transcript, const char *course_code,
+                                     const char *course_code_new, float course_weight_new,
+                                     const char *letter_grade_new) {
+    course_key_t key = course_key_from_code(course_code);
+
+    if (key == COURSE_KEY_INVALID)
+        return CGPA_ERR_CODE;
+
+    const coursenode_t *node = fetch_node_key(transcript, key);
+    if (!node)
+        return CGPA_ERR_NOT_FOUND;
+
+    course_key_t key_new = key;
+    float course_weight = node->course_weight;
+    grade_t grade = (grade_t)node->grade;
+
+    if (course_code_new) {
+        key_new = course_key_from_code(course_code_new);
+        if (key_new == COURSE_KEY_INVALID)
+            return CGPA_ERR_CODE;
+    }
+
+    if (course_weight_new >= 0.0f) {
+        if (!scale_accepts_weight(transcript->scale, course_weight_new))
+            return CGPA_ERR_WEIGHT;
+        course_weight = course_weight_new;
+    }
+
+    if (letter_grade_new && parse_grade(transcript, letter_grade_new, &grade) != CGPA_OK)
+        return CGPA_ERR_GRADE;
+
+    // The course exists; only a code in a new subject allocates
+    return edit_course_key(transcript, key, key_new, course_weight, grade) ? CGPA_OK
+                                                                            : CGPA_ERR_OOM;
+}
+
+cgpa_status_t cgpa_transcript_query(const cgpa_transcript_t *transcript, const char *course_code,
+                                    cgpa_course_t *course) {
+    course_key_t key = course_key_from_code(course_code);
+
+    if (key == COURSE_KEY_INVALID)
+        return CGPA_ERR_CODE;
+
+    const coursenode_t *node = fetch_node_key(transcript, key);
+    if (!node)
+        return CGPA_ERR_NOT_FOUND;
+
+    course_copy(node, course);
+    return CGPA_OK;
+}
+
+size_t cgpa_transcript_count(const cgpa_transcript_t *transcript) {
+    return transcript->count;
+}
+
+cgpa_totals_t cgpa_transcript_totals(const cgpa_transcript_t *transcript) {
+    return cgpa_current(transcript);
+}
+
+cgpa_totals_t cgpa_transcript_term_totals(const cgpa_transcript_t *transcript, term_t term,
+                                          size_t *count) {
+    return cgpa_term(transcript, term, count);
+}
+
+cgpa_totals_t cgpa_transcript_cumulative_totals(const cgpa_transcript_t *transcript, term_t term,
+                                                size_t *count) {
+    return cgpa_through_term(transcript, term, count);
+}
+
+cgpa_totals_t cgpa_transcript_range_totals(const cgpa_transcript_t *transcript, course_key_t first,
+                                           course_key_t last, size_t *count) {
+    return cgpa_range(transcript, first, last, count);
+}
+
+bool cgpa_transcript_each(const cgpa_transcript_t *transcript, cgpa_course_fn fn, void *ctx) {
+    cgpa_course_t course;
+
+    for (const coursenode_t *curr = transcript->head; curr; curr = curr->next) {
+        course_copy(curr, &course);
+        if (!fn(&course, ctx))
+            return false;
+    }
+
+    return true;
+}
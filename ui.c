@@ -0,0 +1,189 @@
+/***********************************
+ * ui.c
+ *
+ * CGPA Calculator - interactive terminal output
+ *
+ * Handles:
+ * - main menu
+ * - course table with totals
+ * - what-if grade plans
+ * - cohort totals per student
+ * - discarding unread input
+ *
+ * Author: Arul Rao (Vidonicle)
+ * License: MIT
+ ***********************************/
+#define _POSIX_C_SOURCE 200809L
+
+#include "ui.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "batch.h"
+#include "cgpa.h"
+#include "instrument.h"
+#include "scale.h"
+#include "whatif.h"
+#include "writer.h"
+
+// Print main menu helper to print on loop
+void print_menu(const grading_scale_t *scale) {
+    printf(
+        "\n =============WELCOME===============\n"
+        "  -Welcome to the CGPA Calculator\n"
+        "  -Please follow all instructions\n"
+        "  -Grading scale: %s (max %.2f)\n"
+        "  -V1.2.4\n"
+        " =========CGPA CALCULATOR===========",
+        scale_name(scale), scale_max_points(scale));
+
+    printf(
+        "\n\n  1. Add a course\n"
+        "  2. Delete a course\n"
+        "  3. Edit a course\n"
+        "  %d. Display Courses and CGPA\n"
+        "  %d. Plan grades for a target CGPA\n"
+        "  %d. Process a cohort file\n"
+        "  %d. Save courses to file\n"
+        "  %d. Exit\n\n"
+        "  Enter your selection (1-%d): ",
+        MENU_DISPLAY, MENU_WHATIF, MENU_BATCH, MENU_SAVE, MENU_EXIT, MENU_EXIT);
+}
+
+// One table row: "  %-12s %4.2f %*s %*.2f\n"
+static bool display_row(const cgpa_course_t *course, void *ctx) {
+    writer_t *out = ctx;
+    const char *letter_grade = grade_to_string(course->grade);
+    int grade_w = (letter_grade[1] == '\0') ? 11 : 12;
+    int credit_w = (letter_grade[1] == '\0') ? 16 : 15;
+
+    writer_puts(out, "  ");
+    writer_pad_right(out, course->course_code, 12);
+    writer_putc(out, ' ');
+    writer_fixed(out, course->course_weight, 2, 4);
+    writer_putc(out, ' ');
+    writer_pad_left(out, letter_grade, grade_w);
+    writer_putc(out, ' ');
+    writer_fixed(out, course->credits_earned, 2, credit_w);
+    writer_putc(out, '\n');
+
+    return true;
+}
+
+// Print grades and formats column sections; false if output failed
+bool display_grades(const cgpa_transcript_t *transcript) {
+    INSTR_START(start);
+    char buf[WRITER_STACK_BUF_LEN];
+    writer_t out;
+
+    writer_init(&out, STDOUT_FILENO, buf, sizeof buf);
+    writer_puts(&out, SEPERATOR1 "  Course Code  Course Weight  Letter Grade  Credits Earned\n");
+
+    cgpa_transcript_each(transcript, display_row, &out);
+
+    cgpa_totals_t totals = cgpa_transcript_totals(transcript);
+
+    writer_puts(&out, "\n\n  Total Credits Earned: ");
+    writer_fixed(&out, totals.credits_earned, 2, 4);
+    writer_puts(&out, "\n  Total Credits Completed: ");
+    writer_fixed(&out, totals.credits_completed, 2, 4);
+    writer_puts(&out, "\n\n  Current CGPA: ");
+    writer_fixed(&out, totals.cgpa, 2, 4);
+    writer_puts(&out, "\n" SEPERATOR2);
+
+    bool ok = writer_flush(&out);
+    INSTR_END(INSTR_DISPLAY, start);
+
+    return ok;
+}
+
+// Planned courses are listed as #1, #2, ... in the course table layout
+bool display_whatif(const grading_scale_t *scale, const float *weights, const grade_t *grades,
+                    size_t count, double target, whatif_status_t status,
+                    const whatif_result_t *result) {
+    const float *points = scale_points(scale);
+    char buf[WRITER_STACK_BUF_LEN];
+    writer_t out;
+
+    writer_init(&out, STDOUT_FILENO, buf, sizeof buf);
+    writer_puts(&out, SEPERATOR1 "  Target CGPA: ");
+    writer_fixed(&out, target, 2, 0);
+    writer_puts(&out, "\n\n  Planned      Course Weight  Letter Grade  Credits Earned\n");
+
+    for (size_t i = 0; i < count; i++) {
+        cgpa_course_t course = {.course_weight = weights[i],
+                                .credits_earned = points[grades[i]] * weights[i],
+                                .grade = grades[i]};
+
+        snprintf(course.course_code, sizeof course.course_code, "#%hu", (unsigned short)(i + 1));
+        display_row(&course, &out);
+    }
+
+    writer_puts(&out, "\n  Planned Credits Earned: ");
+    writer_fixed(&out, result->credits_earned, 2, 4);
+
+    if (status == WHATIF_UNREACHABLE) {
+        writer_puts(&out, "\n\n  Target not reachable; best possible CGPA: ");
+        writer_fixed(&out, result->cgpa, 2, 4);
+    } else {
+        writer_puts(&out, "\n  Lowest grade for every course: ");
+        writer_puts(&out,
+                    result->uniform == GRADE_INVALID ? "none" : grade_to_string(result->uniform));
+        writer_puts(&out, "\n\n  Projected CGPA: ");
+        writer_fixed(&out, result->cgpa, 2, 4);
+    }
+
+    if (!result->optimal)
+        writer_puts(&out, "\n  (search stopped early: grades may not be the lowest possible)");
+
+    writer_puts(&out, "\n" SEPERATOR2);
+
+    return writer_flush(&out);
+}
+
+// Print one row per student, sorted by ID; false on allocation or output failure
+bool display_cohort(const cohort_t *cohort) {
+    const student_totals_t **sorted = cohort_sorted(cohort);
+    char buf[WRITER_STACK_BUF_LEN];
+    writer_t out;
+
+    writer_init(&out, STDOUT_FILENO, buf, sizeof buf);
+    writer_puts(&out,
+                SEPERATOR1 "  Student ID       Courses  Credits Earned  Credits Completed  CGPA\n");
+
+    for (size_t i = 0; sorted && i < cohort->count; i++) {
+        const student_totals_t *student = sorted[i];
+
+        // "  %-16s %7zu %15.2f %18.2f %5.2f\n"
+        writer_puts(&out, "  ");
+        writer_pad_right(&out, student->student_id, 16);
+        writer_putc(&out, ' ');
+        writer_uint(&out, student->courses, 7);
+        writer_putc(&out, ' ');
+        writer_fixed(&out, student->credits_earned, 2, 15);
+        writer_putc(&out, ' ');
+        writer_fixed(&out, student->credits_completed, 2, 18);
+        writer_putc(&out, ' ');
+        writer_fixed(&out, student_cgpa(student), 2, 5);
+        writer_putc(&out, '\n');
+    }
+
+    writer_puts(&out, "\n  Students: ");
+    writer_uint(&out, cohort->count, 0);
+    writer_puts(&out, "\n" SEPERATOR2);
+
+    bool ok = sorted && writer_flush(&out);
+    free(sorted);
+
+    return ok;
+}
+
+// Flush input buffer
+void flush_stdin(void) {
+    int c_flush;
+    while ((c_flush = getchar()) != '\n' && c_flush != EOF);
+}
\ No newline at end of file
@@ -0,0 +1,56 @@
+/***********************************
+ * ui.h
+ *
+ * CGPA Calculator - interactive terminal output
+ *
+ * Defines:
+ * - menu options and separators
+ * - menu, course table, what-if plan, cohort table and stdin helpers
+ *
+ * Author: Arul Rao (Vidonicle)
+ * License: MIT
+ ***********************************/
+
+#ifndef UI_H
+#define UI_H
+
+#include <stdbool.h>
+
+#include "batch.h"
+#include "cgpa.h"
+#include "whatif.h"
+
+#define SEPERATOR1 "\n ===================================\n"  // Seperator for UI elements
+#define SEPERATOR2 " ===================================\n"    // Seperator for stacked elements
+
+typedef enum {
+    MENU_INVALID = 0,  // Invalid option
+
+    MENU_ADD,
+    MENU_DELETE,
+    MENU_EDIT,
+    MENU_DISPLAY,
+    MENU_WHATIF,
+    MENU_BATCH,
+    MENU_SAVE,
+    MENU_EXIT,
+
+    MENU_COUNT
+} menu_option_t;
+
+void print_menu(const grading_scale_t *scale);
+
+// Course table and totals on stdout; false if output failed
+bool display_grades(const cgpa_transcript_t *transcript);
+
+// Planned grades from whatif_solve on stdout; false if output failed
+bool display_whatif(const grading_scale_t *scale, const float *weights, const grade_t *grades,
+                    size_t count, double target, whatif_status_t status,
+                    const whatif_result_t *result);
+
+// One row per student, sorted by ID, on stdout; false on allocation or output failure
+bool display_cohort(const cohort_t *cohort);
+
+void flush_stdin(void);
+
+#endif /* UI_H */
@@ -3,7 +3,7 @@
 #include <stdio.h>
 #include <string.h>
 
-#include "cgpa.h"  // for SEPERATORs and flush_stdin()
+#include "ui.h"  // for SEPERATORs and flush_stdin()
 
 void ui_print_error(ui_error_t err) {
     fprintf(stderr, SEPERATOR2);
@@ -29,6 +29,10 @@ void ui_print_error(ui_error_t err) {
             fprintf(stderr, "\n  Error: invalid letter grade\n");
             break;
 
+        case UI_ERR_INVALID_TARGET:
+            fprintf(stderr, "\n  Error: invalid target CGPA\n");
+            break;
+
         case UI_ERR_DUPLICATE:
             fprintf(stderr, "\n  Error: course already exists\n");
             break;
@@ -49,6 +53,26 @@ void ui_print_error(ui_error_t err) {
             fprintf(stderr, "\n  Error: invalid file type\n");
             break;
 
+        case UI_ERR_FILE_FORMAT:
+            fprintf(stderr, "\n  Error: file is not a valid course snapshot\n");
+            break;
+
+        case UI_ERR_FILE_WRITE:
+            fprintf(stderr, "\n  Error: could not write file\n");
+            break;
+
+        case UI_ERR_SAVE_WEIGHT:
+            fprintf(stderr, "\n  Error: course weights must be multiples of 0.25 to save\n");
+            break;
+
+        case UI_ERR_JOURNAL_OPEN:
+            fprintf(stderr, "\n  Error: could not open or restore the journal\n");
+            break;
+
+        case UI_ERR_JOURNAL_WRITE:
+            fprintf(stderr, "\n  Error: journal write failed; further edits will not be kept\n");
+            break;
+
         case UI_ERR_OOM:
             fprintf(stderr, "\n  Fatal error: out of memory\n");
             break;
@@ -15,11 +15,17 @@ typedef enum {
     UI_ERR_INVALID_CODE,
     UI_ERR_INVALID_WEIGHT,
     UI_ERR_INVALID_GRADE,
+    UI_ERR_INVALID_TARGET,
     UI_ERR_DUPLICATE,
     UI_ERR_NOT_FOUND,
     UI_ERR_EMPTY,
     UI_ERR_FILE_NOT_FOUND,
     UI_ERR_FILE_TYPE,
+    UI_ERR_FILE_FORMAT,
+    UI_ERR_FILE_WRITE,
+    UI_ERR_SAVE_WEIGHT,
+    UI_ERR_JOURNAL_OPEN,
+    UI_ERR_JOURNAL_WRITE,
     UI_ERR_OOM
 } ui_error_t;
 
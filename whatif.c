@@ -0,0 +1,570 @@
+/***********************************
+ * whatif.c
+ *
+ * CGPA Calculator - target CGPA planning
+ *
+ * Handles:
+ * - the lowest uniform grade that reaches a target
+ * - branch and bound over grade assignments for planned courses
+ * - splitting the search into tasks for worker threads
+ * - parsing planned weight lists
+ *
+ * Author: Arul Rao (Vidonicle)
+ * License: MIT
+ ***********************************/
+#define _POSIX_C_SOURCE 200809L
+
+#include "whatif.h"
+
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "cgpa.h"
+#include "instrument.h"
+#include "loader.h"
+#include "scale.h"
+
+#define WHATIF_NODE_BATCH 4096  // Nodes a worker visits between budget checks
+#define WHATIF_TASK_DEPTH 2     // Courses whose grades are fixed by the task number
+#define WHATIF_QUANTUM_SCALE 10000.0  // Weights x points are tried as multiples of 1/this
+
+// One distinct grade point value and the lowest letter that earns it
+typedef struct {
+    float points;
+    grade_t grade;
+} whatif_level_t;
+
+// Planned course, heaviest first once sorted
+typedef struct {
+    float weight;
+    size_t index;  // Position in the caller's arrays
+} whatif_course_t;
+
+/*
+ * The problem, shared read-only by the workers, plus the few fields they
+ * coordinate through. Task t fixes the levels of the first
+ * WHATIF_TASK_DEPTH courses; running tasks in order on one thread is
+ * exactly the serial depth-first search.
+ */
+typedef struct {
+    whatif_level_t levels[GRADE_COUNT];  // Ascending points
+    size_t level_count;
+
+    whatif_course_t *courses;
+    bool *same_group;  // Same weight as the course before: its level may not be higher
+    size_t *group_end;  // One past the last course of the same weight
+    double *rem_min;   // Points from courses i.. at the lowest level
+    double *rem_max;   // ...and at the highest
+    size_t count;
+    double need;   // Planned points needed to reach the target
+    double enough;  // A plan earning no more than this is the best possible
+    double eps;    // Rounding slack in point comparisons
+
+    size_t depth;  // Courses fixed per task
+    size_t task_count;
+    uint8_t *task_paths;  // Best levels per task, count each
+    double *task_best;    // Points of that plan, INFINITY if none
+
+    atomic_size_t next_task;
+    atomic_size_t exact_task;  // Lowest task with a best possible plan; later ones stop
+    atomic_size_t nodes;
+    atomic_bool out_of_budget;
+    _Atomic double bound;  // Fewest points of any plan so far; strictly worse subtrees are cut
+} whatif_search_t;
+
+typedef struct {
+    whatif_search_t *search;
+    uint8_t *path;  // Levels of the courses decided so far
+    size_t task;
+    double best;  // Points of this task's best plan
+    size_t nodes;  // Not yet charged to the shared budget
+    bool stop;
+} whatif_worker_t;
+
+// Credits a course earns, rounded exactly as the course list rounds them
+static double earned(float course_weight, float points) {
+    return (double)(points * course_weight);
+}
+
+static int compare_courses(const void *a, const void *b) {
+    const whatif_course_t *ca = a;
+    const whatif_course_t *cb = b;
+
+    if (ca->weight != cb->weight)
+        return ca->weight > cb->weight ? -1 : 1;
+
+    return ca->index < cb->index ? -1 : ca->index > cb->index;
+}
+
+// Distinct point values the scale awards, ascending, each with its lowest letter
+static size_t scale_levels(const grading_scale_t *scale, whatif_level_t *levels) {
+    const float *points = scale_points(scale);
+    size_t count = 0;
+
+    for (grade_t grade = GRADE_COUNT; grade-- > 0;) {
+        if (!scale_accepts_grade(scale, grade))
+            continue;
+
+        size_t at = 0;
+        while (at < count && levels[at].points < points[grade])
+            at++;
+        if (at < count && levels[at].points == points[grade])
+            continue;
+
+        for (size_t i = count; i > at; i--)
+            levels[i] = levels[i - 1];
+        levels[at] = (whatif_level_t){points[grade], grade};
+        count++;
+    }
+
+    return count;
+}
+
+static uint64_t gcd(uint64_t a, uint64_t b) {
+    while (b) {
+        uint64_t r = a % b;
+        a = b;
+        b = r;
+    }
+
+    return a;
+}
+
+/*
+ * Every plan earns a multiple of the GCD of all weight x points products
+ * (when they are short decimals), so the best possible plan is need
+ * rounded up to that quantum. Returns the most points a plan can earn
+ * and still be the best, which lets the search stop as soon as it finds
+ * one instead of proving there is nothing better.
+ */
+static double plan_enough(const whatif_search_t *search) {
+    uint64_t quantum = 0;
+
+    for (size_t i = 0; i < search->count; i++) {
+        if (search->same_group[i])
+            continue;
+
+        for (size_t level = 0; level < search->level_count; level++) {
+            double scaled = earned(search->courses[i].weight, search->levels[level].points) *
+                            WHATIF_QUANTUM_SCALE;
+            double rounded = round(scaled);
+
+            if (fabs(scaled - rounded) > 1e-6 * (1.0 + scaled) || rounded > (double)UINT32_MAX)
+                return search->need + search->eps;
+            quantum = gcd(quantum, (uint64_t)rounded);
+        }
+    }
+
+    double step = (double)quantum / WHATIF_QUANTUM_SCALE;
+
+    // Products are floats, so sums drift off the multiples; the drift must stay well inside a step
+    double drift = 1e-6 * (1.0 + search->rem_max[0]);
+    if (quantum == 0 || drift > step / 8)
+        return search->need + search->eps;
+
+    double lowest = ceil((search->need - search->eps - drift) / step) * step;
+
+    if (lowest < search->rem_min[0])
+        lowest = search->rem_min[0];
+
+    return lowest + step / 2;
+}
+
+// Lower the shared bound to points if that is an improvement
+static void bound_lower(whatif_search_t *search, double points) {
+    double seen = atomic_load_explicit(&search->bound, memory_order_relaxed);
+
+    while (points < seen &&
+           !atomic_compare_exchange_weak_explicit(&search->bound, &seen, points,
+                                                  memory_order_relaxed, memory_order_relaxed))
+        ;
+}
+
+// Count a node; false once the budget is spent or an earlier task hit the target
+static bool worker_charge(whatif_worker_t *w) {
+    whatif_search_t *search = w->search;
+
+    if (++w->nodes < WHATIF_NODE_BATCH)
+        return true;
+
+    size_t total = atomic_fetch_add_explicit(&search->nodes, w->nodes, memory_order_relaxed);
+    w->nodes = 0;
+
+    if (total >= WHATIF_NODE_BUDGET) {
+        atomic_store_explicit(&search->out_of_budget, true, memory_order_relaxed);
+        w->stop = true;
+    } else if (atomic_load_explicit(&search->exact_task, memory_order_relaxed) < w->task) {
+        w->stop = true;
+    }
+
+    return !w->stop;
+}
+
+// Courses from i on all take the lowest level: keep the plan if it is this task's best
+static void worker_record(whatif_worker_t *w, size_t i, double points) {
+    whatif_search_t *search = w->search;
+    uint8_t *best_path = search->task_paths + w->task * search->count;
+
+    for (size_t j = 0; j < i; j++)
+        best_path[j] = w->path[j];
+    for (size_t j = i; j < search->count; j++)
+        best_path[j] = 0;
+
+    w->best = points;
+    bound_lower(search, points);
+
+    // Later tasks cannot win against a best possible plan
+    if (points <= search->enough) {
+        size_t exact = atomic_load_explicit(&search->exact_task, memory_order_relaxed);
+
+        while (w->task < exact &&
+               !atomic_compare_exchange_weak_explicit(&search->exact_task, &exact, w->task,
+                                                      memory_order_relaxed, memory_order_relaxed))
+            ;
+        w->stop = true;
+    }
+}
+
+// Most points courses i.. can add when none in i's group may pass level cap
+static double search_high(const whatif_search_t *search, size_t i, size_t cap) {
+    size_t end = search->group_end[i];
+
+    return (double)(end - i) * earned(search->courses[i].weight, search->levels[cap].points) +
+           search->rem_max[end];
+}
+
+// Depth-first search over the levels of course i onward, given sum points so far
+static void worker_search(whatif_worker_t *w, size_t i, double sum) {
+    const whatif_search_t *search = w->search;
+
+    if (!worker_charge(w))
+        return;
+
+    if (i == search->count) {
+        if (sum >= search->need - search->eps && sum < w->best - search->eps)
+            worker_record(w, i, sum);
+        return;
+    }
+
+    size_t cap = search->same_group[i] ? w->path[i - 1] : search->level_count - 1;
+
+    // Cannot reach the target even with the best grades left
+    if (sum + search_high(search, i, cap) < search->need - search->eps)
+        return;
+
+    // Cannot beat a plan already found
+    double low = sum + search->rem_min[i];
+    if (low >= w->best - search->eps ||
+        low > atomic_load_explicit(&w->search->bound, memory_order_relaxed) + search->eps)
+        return;
+
+    if (low >= search->need - search->eps) {
+        worker_record(w, i, low);
+        return;
+    }
+
+    float weight = search->courses[i].weight;
+
+    for (size_t level = 0; level <= cap && !w->stop; level++) {
+        double next = sum + earned(weight, search->levels[level].points);
+
+        // Higher levels only add points
+        if (next + search->rem_min[i + 1] >= w->best - search->eps)
+            break;
+
+        w->path[i] = (uint8_t)level;
+        worker_search(w, i + 1, next);
+    }
+}
+
+// Fix the first courses from the task number, then search the rest
+static void worker_task(whatif_worker_t *w, size_t task) {
+    whatif_search_t *search = w->search;
+    double sum = 0.0;
+    size_t code = task;
+
+    for (size_t i = search->depth; i-- > 0; code /= search->level_count)
+        w->path[i] = (uint8_t)(code % search->level_count);
+
+    for (size_t i = 0; i < search->depth; i++) {
+        if (search->same_group[i] && w->path[i] > w->path[i - 1])
+            return;  // Mirror image of an earlier task
+        sum += earned(search->courses[i].weight, search->levels[w->path[i]].points);
+    }
+
+    w->task = task;
+    w->best = INFINITY;
+    w->stop = false;
+
+    worker_search(w, search->depth, sum);
+    search->task_best[task] = w->best;
+}
+
+static void *worker_run(void *arg) {
+    whatif_worker_t *w = arg;
+    whatif_search_t *search = w->search;
+
+    for (;;) {
+        size_t task = atomic_fetch_add_explicit(&search->next_task, 1, memory_order_relaxed);
+
+        if (task >= search->task_count ||
+            atomic_load_explicit(&search->out_of_budget, memory_order_relaxed) ||
+            atomic_load_explicit(&search->exact_task, memory_order_relaxed) < task)
+            break;
+
+        worker_task(w, task);
+    }
+
+    atomic_fetch_add_explicit(&search->nodes, w->nodes, memory_order_relaxed);
+    w->nodes = 0;
+
+    return NULL;
+}
+
+// Run every task on up to threads workers, the calling thread included
+static bool search_run(whatif_search_t *search, size_t threads) {
+    whatif_worker_t *workers = calloc(threads, sizeof *workers);
+    pthread_t *tids = calloc(threads, sizeof *tids);
+    uint8_t *paths = malloc(threads * search->count);
+    bool ok = workers && tids && paths;
+
+    size_t started = 0;
+    for (size_t i = 0; ok && i < threads; i++) {
+        workers[i].search = search;
+        workers[i].path = paths + i * search->count;
+
+        // A worker that cannot start leaves its share to the others
+        if (i > 0 && pthread_create(&tids[i], NULL, worker_run, &workers[i]) != 0)
+            break;
+        started = i + 1;
+    }
+
+    if (ok)
+        worker_run(&workers[0]);
+    for (size_t i = 1; i < started; i++)
+        pthread_join(tids[i], NULL);
+
+    free(paths);
+    free(tids);
+    free(workers);
+
+    return ok;
+}
+
+static size_t search_threads(const whatif_search_t *search, size_t threads) {
+    if (search->count < WHATIF_PARALLEL_MIN)
+        return 1;
+
+    if (threads == 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = online > 0 ? (size_t)online : 1;
+    }
+    if (threads > WHATIF_MAX_THREADS)
+        threads = WHATIF_MAX_THREADS;
+    if (threads > search->task_count)
+        threads = search->task_count;
+
+    return threads;
+}
+
+static void search_free(whatif_search_t *search) {
+    free(search->courses);
+    free(search->same_group);
+    free(search->group_end);
+    free(search->rem_min);
+    free(search->rem_max);
+    free(search->task_paths);
+    free(search->task_best);
+}
+
+// Sort the plan, precompute suffix bounds and size the task table
+static bool search_init(whatif_search_t *search, const float *weights, size_t count) {
+    search->count = count;
+    search->courses = malloc(count * sizeof *search->courses);
+    search->same_group = malloc(count * sizeof *search->same_group);
+    search->group_end = malloc(count * sizeof *search->group_end);
+    search->rem_min = malloc((count + 1) * sizeof *search->rem_min);
+    search->rem_max = malloc((count + 1) * sizeof *search->rem_max);
+
+    search->depth = count < WHATIF_TASK_DEPTH ? count : WHATIF_TASK_DEPTH;
+    search->task_count = 1;
+    for (size_t i = 0; i < search->depth; i++)
+        search->task_count *= search->level_count;
+
+    search->task_paths = malloc(search->task_count * count);
+    search->task_best = malloc(search->task_count * sizeof *search->task_best);
+
+    if (!search->courses || !search->same_group || !search->group_end || !search->rem_min ||
+        !search->rem_max || !search->task_paths || !search->task_best)
+        return false;
+
+    for (size_t i = 0; i < count; i++)
+        search->courses[i] = (whatif_course_t){weights[i], i};
+    qsort(search->courses, count, sizeof *search->courses, compare_courses);
+
+    float low = search->levels[0].points;
+    float high = search->levels[search->level_count - 1].points;
+
+    search->rem_min[count] = search->rem_max[count] = 0.0;
+    for (size_t i = count; i-- > 0;) {
+        search->same_group[i] = i > 0 && search->courses[i].weight == search->courses[i - 1].weight;
+        search->rem_min[i] = search->rem_min[i + 1] + earned(search->courses[i].weight, low);
+        search->rem_max[i] = search->rem_max[i + 1] + earned(search->courses[i].weight, high);
+        search->group_end[i] = i + 1 < count && search->same_group[i + 1]
+                                   ? search->group_end[i + 1]
+                                   : i + 1;
+    }
+
+    for (size_t t = 0; t < search->task_count; t++)
+        search->task_best[t] = INFINITY;
+
+    search->enough = plan_enough(search);
+
+    atomic_init(&search->next_task, 0);
+    atomic_init(&search->exact_task, SIZE_MAX);
+    atomic_init(&search->nodes, 0);
+    atomic_init(&search->out_of_budget, false);
+    atomic_init(&search->bound, INFINITY);
+
+    return true;
+}
+
+// Give each planned course the grade at its level and total the plan
+static void plan_apply(const whatif_search_t *search, const uint8_t *path,
+                       const cgpa_totals_t *current, grade_t *grades, whatif_result_t *result) {
+    double credits = 0.0;
+    double completed = current->credits_completed;
+
+    for (size_t i = 0; i < search->count; i++) {
+        const whatif_level_t *level = &search->levels[path[i]];
+
+        grades[search->courses[i].index] = level->grade;
+        credits += earned(search->courses[i].weight, level->points);
+        completed += search->courses[i].weight;
+    }
+
+    result->credits_earned = credits;
+    result->cgpa = completed > 0.0 ? (current->credits_earned + credits) / completed : 0.0;
+}
+
+// Points earned with every planned course at one level
+static double plan_uniform(const whatif_search_t *search, size_t level) {
+    double credits = 0.0;
+
+    for (size_t i = 0; i < search->count; i++)
+        credits += earned(search->courses[i].weight, search->levels[level].points);
+
+    return credits;
+}
+
+bool whatif_plan_from_string(const char *plan, float *weights, size_t *count) {
+    static const char separators[] = " ,\t\r\n";
+
+    *count = 0;
+
+    for (const char *p = plan + strspn(plan, separators); *p; p += strspn(p, separators)) {
+        size_t len = strcspn(p, separators);
+
+        if (*count == WHATIF_MAX_PLANNED || !parse_weight(p, len, &weights[*count]))
+            return false;
+
+        (*count)++;
+        p += len;
+    }
+
+    return true;
+}
+
+whatif_status_t whatif_solve(const cgpa_totals_t *current, const grading_scale_t *scale,
+                             const float *weights, size_t count, double target, size_t threads,
+                             grade_t *grades, whatif_result_t *result) {
+    if (!isfinite(target) || target < 0.0)
+        return WHATIF_ERR_TARGET;
+    if (count > WHATIF_MAX_PLANNED)
+        return WHATIF_ERR_PLAN;
+
+    double planned = 0.0;
+    for (size_t i = 0; i < count; i++) {
+        if (!isfinite(weights[i]) || !scale_accepts_weight(scale, weights[i]))
+            return WHATIF_ERR_WEIGHT;
+        planned += weights[i];
+    }
+
+    *result = (whatif_result_t){.uniform = GRADE_INVALID, .optimal = true};
+
+    whatif_search_t search = {0};
+    search.level_count = scale_levels(scale, search.levels);
+    if (search.level_count == 0)
+        return WHATIF_UNREACHABLE;
+
+    INSTR_START(start);
+
+    double total = current->credits_completed + planned;
+    search.need = target * total - current->credits_earned;
+    search.eps = 1e-9 * (1.0 + fabs(current->credits_earned) +
+                         planned * search.levels[search.level_count - 1].points);
+
+    if (!search_init(&search, weights, count)) {
+        search_free(&search);
+        return WHATIF_ERR_OOM;
+    }
+
+    whatif_status_t status = WHATIF_OK;
+    size_t uniform = 0;
+
+    // The lowest uniform grade is a plan too, so its points bound the search
+    for (; uniform < search.level_count; uniform++) {
+        double credits = plan_uniform(&search, uniform);
+
+        if (credits >= search.need - search.eps) {
+            result->uniform = search.levels[uniform].grade;
+            atomic_store(&search.bound, credits);
+            break;
+        }
+    }
+
+    if (search.rem_max[0] < search.need - search.eps) {
+        // Unreachable: report the best grades and the CGPA they give
+        uint8_t *path = search.task_paths;
+
+        for (size_t i = 0; i < count; i++)
+            path[i] = (uint8_t)(search.level_count - 1);
+        plan_apply(&search, path, current, grades, result);
+        status = WHATIF_UNREACHABLE;
+    } else if (count == 0) {
+        plan_apply(&search, NULL, current, grades, result);
+    } else if (!search_run(&search, search_threads(&search, threads))) {
+        status = WHATIF_ERR_OOM;
+    } else {
+        // Fewest points wins; ties go to the earliest task, as in a serial search
+        size_t best = 0;
+        for (size_t t = 1; t < search.task_count; t++) {
+            if (search.task_best[t] < search.task_best[best] - search.eps)
+                best = t;
+        }
+
+        uint8_t *path = search.task_paths + best * count;
+
+        // Out of budget before any plan: fall back to the uniform one
+        if (search.task_best[best] == INFINITY) {
+            for (size_t i = 0; i < count; i++)
+                path[i] = (uint8_t)uniform;
+        }
+
+        plan_apply(&search, path, current, grades, result);
+        result->optimal = !atomic_load(&search.out_of_budget);
+        result->nodes = atomic_load(&search.nodes);
+    }
+
+    search_free(&search);
+    INSTR_END(INSTR_WHATIF, start);
+
+    return status;
+}
@@ -0,0 +1,70 @@
+/***********************************
+ * whatif.h
+ *
+ * CGPA Calculator - target CGPA planning
+ *
+ * Defines:
+ * - the what-if solver for grades needed on planned courses
+ * - planned weight list parsing
+ * - solver status codes and results
+ *
+ * Author: Arul Rao (Vidonicle)
+ * License: MIT
+ ***********************************/
+
+#ifndef WHATIF_H
+#define WHATIF_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "cgpa.h"
+
+#define WHATIF_MAX_PLANNED 256        // Planned courses per solve
+#define WHATIF_NODE_BUDGET 4000000u   // Search nodes before settling for the best plan found
+#define WHATIF_PARALLEL_MIN 12        // Smaller plans are searched on one thread
+#define WHATIF_MAX_THREADS 64
+
+typedef enum {
+    WHATIF_OK = 0,
+    WHATIF_UNREACHABLE,  // Even the best grades fall short; grades holds the best grades
+    WHATIF_ERR_TARGET,   // Target is negative or not a number
+    WHATIF_ERR_WEIGHT,   // A planned weight is not accepted by the scale
+    WHATIF_ERR_PLAN,     // More than WHATIF_MAX_PLANNED courses
+    WHATIF_ERR_OOM
+} whatif_status_t;
+
+typedef struct {
+    grade_t uniform;        // Lowest grade that reaches the target in every planned course
+                            // (GRADE_INVALID if none does)
+    double credits_earned;  // Credits the planned grades earn
+    double cgpa;            // CGPA once the planned courses are graded
+    bool optimal;           // False if WHATIF_NODE_BUDGET cut the search short
+    size_t nodes;           // Search nodes visited
+} whatif_result_t;
+
+/*
+ * Parse planned weights separated by spaces or commas, such as
+ * "0.5 0.5 1.0". Returns false on a token that is not a weight or more
+ * than WHATIF_MAX_PLANNED of them.
+ */
+bool whatif_plan_from_string(const char *plan, float *weights, size_t *count);
+
+/*
+ * Grades for planned courses of the given weights that lift current to
+ * at least target while earning the fewest planned credits. Ties favour
+ * lower grades in heavier courses and even grades across courses of
+ * equal weight. grades[i] receives the grade for weights[i], using only
+ * letters scale (NULL = built-in) accepts.
+ *
+ * The search is a branch and bound over the scale's distinct grade
+ * points, heaviest course first. Plans of WHATIF_PARALLEL_MIN or more
+ * courses are split over up to threads workers (0 = one per online
+ * core); the plan found does not depend on the thread count unless the
+ * node budget runs out.
+ */
+whatif_status_t whatif_solve(const cgpa_totals_t *current, const grading_scale_t *scale,
+                             const float *weights, size_t count, double target, size_t threads,
+                             grade_t *grades, whatif_result_t *result);
+
+#endif /* WHATIF_H */
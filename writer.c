@@ -0,0 +1,238 @@
+/***********************************
+ * writer.c
+ *
+ * CGPA Calculator - buffered output writer
+ *
+ * Handles:
+ * - buffering report output and flushing it with write(2)
+ * - hand-rolled integer and fixed-point formatting
+ *
+ * Author: Arul Rao (Vidonicle)
+ * License: MIT
+ ***********************************/
+#define _POSIX_C_SOURCE 200809L
+
+#include "writer.h"
+
+#include <errno.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#define NUM_BUF_LEN 32     // Digits of any uint64_t plus sign and point
+#define MAX_DECIMALS 9     // Fixed-point precision limit
+
+static const double pow10_table[MAX_DECIMALS + 1] = {1e0, 1e1, 1e2, 1e3, 1e4,
+                                                     1e5, 1e6, 1e7, 1e8, 1e9};
+
+void writer_init(writer_t *w, int fd, char *buf, size_t cap) {
+    if (fd == STDOUT_FILENO)
+        fflush(stdout);
+
+    w->fd = fd;
+    w->buf = buf;
+    w->len = 0;
+    w->cap = cap;
+    w->failed = false;
+}
+
+bool writer_flush(writer_t *w) {
+    size_t off = 0;
+
+    while (off < w->len && !w->failed) {
+        ssize_t n = write(w->fd, w->buf + off, w->len - off);
+
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            w->failed = true;
+        else
+            off += (size_t)n;
+    }
+
+    w->len = 0;
+    return !w->failed;
+}
+
+void writer_write(writer_t *w, const char *data, size_t len) {
+    while (len > 0) {
+        if (w->len == w->cap && !writer_flush(w))
+            return;
+
+        size_t n = w->cap - w->len;
+        if (n > len)
+            n = len;
+
+        memcpy(w->buf + w->len, data, n);
+        w->len += n;
+        data += n;
+        len -= n;
+    }
+}
+
+void writer_puts(writer_t *w, const char *str) {
+    writer_write(w, str, strlen(str));
+}
+
+void writer_putc(writer_t *w, char c) {
+    if (w->len == w->cap && !writer_flush(w))
+        return;
+
+    w->buf[w->len++] = c;
+}
+
+static void writer_spaces(writer_t *w, int count) {
+    for (; count > 0; count--)
+        writer_putc(w, ' ');
+}
+
+void writer_pad_left(writer_t *w, const char *str, int width) {
+    size_t len = strlen(str);
+
+    writer_spaces(w, width - (int)len);
+    writer_write(w, str, len);
+}
+
+void writer_pad_right(writer_t *w, const char *str, int width) {
+    size_t len = strlen(str);
+
+    writer_write(w, str, len);
+    writer_spaces(w, width - (int)len);
+}
+
+// Digits of value, written backwards from end; returns start
+static char *format_uint(char *end, uint64_t value) {
+    char *p = end;
+
+    do {
+        *--p = (char)('0' + value % 10);
+        value /= 10;
+    } while (value);
+
+    return p;
+}
+
+void writer_uint(writer_t *w, uint64_t value, int width) {
+    char num[NUM_BUF_LEN];
+    char *end = num + sizeof num;
+    char *start = format_uint(end, value);
+
+    writer_spaces(w, width - (int)(end - start));
+    writer_write(w, start, (size_t)(end - start));
+}
+
+/*
+ * Exact product a * b = *prod + *err (Dekker / Veltkamp split).
+ * Relies on no FMA contraction, which -std=c11 guarantees for GCC.
+ */
+static void two_product(double a, double b, double *prod, double *err) {
+    const double split = 134217729.0;  // 2^27 + 1
+
+    *prod = a * b;
+
+    double t = split * a;
+    double a_hi = t - (t - a);
+    double a_lo = a - a_hi;
+
+    t = split * b;
+    double b_hi = t - (t - b);
+    double b_lo = b - b_hi;
+
+    *err = ((a_hi * b_hi - *prod) + a_hi * b_lo + a_lo * b_hi) + a_lo * b_lo;
+}
+
+/*
+ * Finite values too large for the integer path, as d.dddddde+NN: still
+ * a number to JSON and CSV readers, and built without snprintf so the
+ * signal handler's dump stays async-signal-safe.
+ */
+static void writer_exponent(writer_t *w, double value, int width) {
+    char num[NUM_BUF_LEN];
+    char *end = num + sizeof num;
+    char *p = end;
+    bool negative = value < 0.0;
+    unsigned exponent = 0;
+
+    if (negative)
+        value = -value;
+    for (; value >= 10.0; value /= 10.0)
+        exponent++;
+
+    uint64_t units = (uint64_t)(value * 1e6 + 0.5);  // 7 significant digits
+    if (units >= 10000000) {
+        units /= 10;
+        exponent++;
+    }
+
+    p = format_uint(p, exponent);
+    if (exponent < 10)
+        *--p = '0';
+    *--p = '+';
+    *--p = 'e';
+    for (int i = 0; i < 6; i++, units /= 10)
+        *--p = (char)('0' + units % 10);
+    *--p = '.';
+    *--p = (char)('0' + units);
+    if (negative)
+        *--p = '-';
+
+    writer_spaces(w, width - (int)(end - p));
+    writer_write(w, p, (size_t)(end - p));
+}
+
+void writer_fixed(writer_t *w, double value, int decimals, int width) {
+    if (decimals < 0)
+        decimals = 0;
+    if (decimals > MAX_DECIMALS)
+        decimals = MAX_DECIMALS;
+
+    bool negative = value < 0.0;
+    double scaled;
+    double err;
+
+    two_product(negative ? -value : value, pow10_table[decimals], &scaled, &err);
+
+    // Loaders and scales bound weights and points, so no transcript gets here
+    if (!isfinite(value)) {
+        writer_spaces(w, width - 4);
+        writer_write(w, "null", 4);
+        return;
+    }
+    if (!(scaled < 1e15)) {
+        writer_exponent(w, value, width);
+        return;
+    }
+
+    // Round the exact product, ties to even, the way printf does
+    uint64_t units = (uint64_t)scaled;
+    double frac = scaled - (double)units;
+
+    if (frac > 0.5 || (frac == 0.5 && (err > 0.0 || (err == 0.0 && (units & 1)))))
+        units++;
+
+    uint64_t divisor = (uint64_t)pow10_table[decimals];
+    char num[NUM_BUF_LEN];
+    char *end = num + sizeof num;
+    char *p = end;
+
+    if (decimals > 0) {
+        uint64_t fraction = units % divisor;
+
+        for (int i = 0; i < decimals; i++) {
+            *--p = (char)('0' + fraction % 10);
+            fraction /= 10;
+        }
+        *--p = '.';
+    }
+
+    p = format_uint(p, units / divisor);
+    if (negative)
+        *--p = '-';
+
+    writer_spaces(w, width - (int)(end - p));
+    writer_write(w, p, (size_t)(end - p));
+}
@@ -0,0 +1,67 @@
+/***********************************
+ * writer.h
+ *
+ * CGPA Calculator - buffered output writer
+ *
+ * Defines:
+ * - a write(2)-backed output buffer
+ * - fixed-point and padded field formatting without printf
+ *
+ * Author: Arul Rao (Vidonicle)
+ * License: MIT
+ ***********************************/
+
+#ifndef WRITER_H
+#define WRITER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define WRITER_STACK_BUF_LEN 65536     // Buffer size for writers on the stack
+#define WRITER_REPORT_BUF_LEN (1 << 20)  // Buffer size for large reports
+
+typedef struct {
+    int fd;
+    char *buf;  // Caller-owned
+    size_t len;
+    size_t cap;
+    bool failed;  // Sticky once a write fails
+} writer_t;
+
+/*
+ * Start writing to fd through buf.
+ * When fd is stdout, stdio's stdout is flushed first so output stays
+ * in order with earlier printf calls.
+ */
+void writer_init(writer_t *w, int fd, char *buf, size_t cap);
+
+void writer_write(writer_t *w, const char *data, size_t len);
+
+void writer_puts(writer_t *w, const char *str);
+
+void writer_putc(writer_t *w, char c);
+
+// Like "%*s": right-aligned in width
+void writer_pad_left(writer_t *w, const char *str, int width);
+
+// Like "%-*s": left-aligned in width
+void writer_pad_right(writer_t *w, const char *str, int width);
+
+/*
+ * Like "%*.*f", rounding half to even on the scaled value. Values of
+ * 1e15 units or more are written as d.dddddde+NN, and NaN or infinity
+ * as null, so JSON output stays valid.
+ */
+void writer_fixed(writer_t *w, double value, int decimals, int width);
+
+// Like "%*llu"
+void writer_uint(writer_t *w, uint64_t value, int width);
+
+/*
+ * Write out everything buffered with as few write calls as possible.
+ * Returns false if any write so far has failed.
+ */
+bool writer_flush(writer_t *w);
+
+#endif /* WRITER_H */